@@ -0,0 +1,489 @@
+/*
+ * Loads the same bids into the HashTable, BinarySearchTree, LinkedList
+ * and sorted vector engines and runs the same scripted workloads on
+ * each, reporting latency percentiles, throughput and memory as JSON
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Bid.hpp"
+#include "BinarySearchTree.hpp"
+#include "HashTable.hpp"
+#include "LinkedList.hpp"
+#include "SortEngines.hpp"
+#include "ZipfDistribution.hpp"
+
+using namespace std;
+
+// Bytes the engines currently hold through CountingAllocator
+size_t allocatedBytes = 0;
+
+// Allocator that keeps allocatedBytes up to date, so the memory each
+// engine's structure takes can be read off exactly. The strings inside
+// the bids allocate on their own and are not counted.
+template<class T>
+struct CountingAllocator {
+	typedef T value_type;
+
+	CountingAllocator() {
+	}
+	template<class U>
+	CountingAllocator(const CountingAllocator<U>&) {
+	}
+	T* allocate(size_t count) {
+		allocatedBytes += count * sizeof(T);
+		return static_cast<T*>(::operator new(count * sizeof(T)));
+	}
+	void deallocate(T *pointer, size_t count) {
+		allocatedBytes -= count * sizeof(T);
+		::operator delete(pointer);
+	}
+};
+
+template<class T, class U>
+bool operator==(const CountingAllocator<T>&, const CountingAllocator<U>&) {
+	return true;
+}
+
+template<class T, class U>
+bool operator!=(const CountingAllocator<T>&, const CountingAllocator<U>&) {
+	return false;
+}
+
+// Zipf exponent, the k-th most popular bid is looked up in
+// proportion to 1 / k^s
+const double ZIPF_EXPONENT = 1.0;
+
+// Full passes over each engine in the scan workload
+const unsigned int SCAN_PASSES = 20;
+
+// Scans write here so the compiler cannot drop them
+volatile double scanSink = 0.0;
+
+// The operations every engine is driven through
+struct Workloads {
+	vector<Bid> bids; // bulk loaded, in file order
+	vector<string> uniform; // IDs of loaded bids, equally likely
+	vector<string> zipf; // IDs of loaded bids, Zipf popularity
+	vector<string> hit90; // 90% loaded IDs, 10% IDs never loaded
+	vector<string> hit50; // half loaded IDs, half never loaded
+	vector<string> churnRemove; // loaded IDs, each removed once
+	vector<Bid> churnInsert; // new bids put back in their place
+};
+
+// Latencies of one workload on one engine, and how many of its
+// operations that look for a bid found one
+struct Measurement {
+	vector<double> nanoseconds; // one per operation, or one for the batch
+	double seconds;
+	unsigned int operations;
+	unsigned int searches; // lookups and removes
+	unsigned int hits; // searches that found their bid
+	Measurement() :
+			seconds(0.0), operations(0), searches(0), hits(0) {
+	}
+};
+
+/*
+ * Each engine offers Load, Find, Insert, Remove and Scan over bids so
+ * one templated runner drives them all without virtual calls
+ */
+
+class HashTableEngine {
+private:
+	typedef core::HashTable<string, Bid, BidIdOf, BidIdHash, equal_to<string>,
+			CountingAllocator<Bid> > Table;
+	Table *table;
+
+public:
+	HashTableEngine() :
+			table(nullptr) {
+	}
+	~HashTableEngine() {
+		delete table;
+	}
+	HashTableEngine(const HashTableEngine&) = delete;
+	HashTableEngine &operator=(const HashTableEngine&) = delete;
+	static const char* Name() {
+		return "HashTable";
+	}
+	// one bucket per bid, so chains stay short
+	void Load(const vector<Bid> &bids) {
+		delete table;
+		table = new Table(max((unsigned int) bids.size(), 1U));
+		for (const Bid &bid : bids) {
+			table->Insert(bid);
+		}
+	}
+	bool Find(const string &bidId) {
+		return table->Find(bidId) != nullptr;
+	}
+	void Insert(const Bid &bid) {
+		table->Insert(bid);
+	}
+	bool Remove(const string &bidId) {
+		return table->Remove(bidId);
+	}
+	double Scan() const {
+		double total = 0.0;
+		table->ForEach([&total](unsigned int, const Bid &bid) {
+			total += bid.amount;
+		});
+		return total;
+	}
+};
+
+class BinarySearchTreeEngine {
+private:
+	core::BinarySearchTree<string, Bid, BidIdOf, BidIdLess,
+			CountingAllocator<Bid> > tree;
+
+public:
+	static const char* Name() {
+		return "BinarySearchTree";
+	}
+	void Load(const vector<Bid> &bids) {
+		tree.Clear();
+		for (const Bid &bid : bids) {
+			tree.Insert(bid);
+		}
+	}
+	bool Find(const string &bidId) {
+		return tree.Find(bidId) != nullptr;
+	}
+	void Insert(const Bid &bid) {
+		tree.Insert(bid);
+	}
+	bool Remove(const string &bidId) {
+		return tree.Remove(bidId);
+	}
+	double Scan() const {
+		double total = 0.0;
+		tree.InOrder([&total](const Bid &bid) {
+			total += bid.amount;
+		});
+		return total;
+	}
+};
+
+// Unindexed, in file order, as the LinkedList program keeps it
+class LinkedListEngine {
+private:
+	core::LinkedList<string, Bid, BidIdOf, hash<string>, equal_to<string>,
+			CountingAllocator<Bid> > list;
+
+public:
+	static const char* Name() {
+		return "LinkedList";
+	}
+	void Load(const vector<Bid> &bids) {
+		list.Clear();
+		for (const Bid &bid : bids) {
+			list.Append(bid);
+		}
+	}
+	bool Find(const string &bidId) {
+		return list.Find(bidId) != nullptr;
+	}
+	void Insert(const Bid &bid) {
+		list.Append(bid);
+	}
+	bool Remove(const string &bidId) {
+		return list.Remove(bidId);
+	}
+	double Scan() const {
+		double total = 0.0;
+		list.ForEach([&total](const Bid &bid) {
+			total += bid.amount;
+		});
+		return total;
+	}
+};
+
+// Kept sorted by bid ID, found by binary search
+class SortedVectorEngine {
+private:
+	typedef core::KeyLess<BidIdOf, BidIdLess> IdLess;
+	typedef vector<Bid, CountingAllocator<Bid> > Bids;
+	Bids bids;
+
+	Bids::iterator lowerBound(const string &bidId) {
+		return lower_bound(bids.begin(), bids.end(), bidId,
+				[](const Bid &bid, const string &key) {
+					return bid.bidId < key;
+				});
+	}
+
+public:
+	static const char* Name() {
+		return "SortedVector";
+	}
+	void Load(const vector<Bid> &loaded) {
+		bids.assign(loaded.begin(), loaded.end());
+		core::pdqSort(bids, IdLess());
+	}
+	bool Find(const string &bidId) {
+		Bids::iterator found = lowerBound(bidId);
+		return found != bids.end() && found->bidId == bidId;
+	}
+	void Insert(const Bid &bid) {
+		bids.insert(lowerBound(bid.bidId), bid);
+	}
+	bool Remove(const string &bidId) {
+		Bids::iterator found = lowerBound(bidId);
+		if (found == bids.end() || found->bidId != bidId) {
+			return false;
+		}
+		bids.erase(found);
+		return true;
+	}
+	double Scan() const {
+		double total = 0.0;
+		for (const Bid &bid : bids) {
+			total += bid.amount;
+		}
+		return total;
+	}
+};
+
+/**
+ * Script the workloads over a set of bids. The same bids and seed
+ * always give the same operations.
+ *
+ * @param bids Bids every engine loads
+ * @param operations Operations in each lookup and churn workload
+ * @param seed Seed for the random choices
+ */
+Workloads scriptWorkloads(const vector<Bid> &bids, unsigned int operations,
+		unsigned long long seed) {
+	Workloads workloads;
+	workloads.bids = bids;
+
+	mt19937_64 random(seed);
+	uniform_int_distribution<size_t> anyBid(0, bids.size() - 1);
+
+	// IDs past the largest loaded one are never hits
+	long long largest = 0;
+	for (const Bid &bid : bids) {
+		largest = max(largest, atoll(bid.bidId.c_str()));
+	}
+	long long nextMiss = largest + 1;
+	long long nextNew = largest + 1 + 2LL * operations;
+
+	for (unsigned int i = 0; i < operations; ++i) {
+		workloads.uniform.push_back(bids[anyBid(random)].bidId);
+	}
+
+	// popularity ranks over a shuffled copy of the bids
+	vector<size_t> byPopularity(bids.size());
+	for (size_t i = 0; i < byPopularity.size(); ++i) {
+		byPopularity[i] = i;
+	}
+	shuffle(byPopularity.begin(), byPopularity.end(), random);
+
+	core::ZipfDistribution popularity(byPopularity.size(), ZIPF_EXPONENT);
+	for (unsigned int i = 0; i < operations; ++i) {
+		workloads.zipf.push_back(bids[byPopularity[popularity(random)]].bidId);
+	}
+
+	bernoulli_distribution hit90(0.9);
+	bernoulli_distribution hit50(0.5);
+	for (unsigned int i = 0; i < operations; ++i) {
+		workloads.hit90.push_back(
+				hit90(random) ?
+						bids[anyBid(random)].bidId : to_string(nextMiss++));
+		workloads.hit50.push_back(
+				hit50(random) ?
+						bids[anyBid(random)].bidId : to_string(nextMiss++));
+	}
+
+	// remove then insert, so the engine keeps its size
+	vector<size_t> removeOrder = byPopularity;
+	shuffle(removeOrder.begin(), removeOrder.end(), random);
+	unsigned int churn = min((size_t) operations / 2, removeOrder.size());
+	for (unsigned int i = 0; i < churn; ++i) {
+		const Bid &removed = bids[removeOrder[i]];
+		workloads.churnRemove.push_back(removed.bidId);
+		Bid inserted = removed;
+		inserted.bidId = to_string(nextNew++);
+		workloads.churnInsert.push_back(inserted);
+	}
+
+	return workloads;
+}
+
+// Nanoseconds since start
+inline double elapsedNanoseconds(chrono::steady_clock::time_point start) {
+	return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Time one lookup per bid ID
+ */
+template<class Engine>
+Measurement measureFinds(Engine &engine, const vector<string> &bidIds) {
+	Measurement measurement;
+	measurement.nanoseconds.reserve(bidIds.size());
+	for (const string &bidId : bidIds) {
+		auto start = chrono::steady_clock::now();
+		bool found = engine.Find(bidId);
+		measurement.nanoseconds.push_back(elapsedNanoseconds(start));
+		measurement.hits += found;
+	}
+	measurement.operations = bidIds.size();
+	measurement.searches = bidIds.size();
+	return measurement;
+}
+
+/**
+ * The latency below which a share of the operations finished
+ *
+ * @param sorted Latencies in ascending order
+ * @param share Between 0 and 1, such as 0.99 for p99
+ */
+double percentile(const vector<double> &sorted, double share) {
+	if (sorted.empty()) {
+		return 0.0;
+	}
+	size_t rank = (size_t) ceil(share * sorted.size());
+	return sorted[min(max(rank, (size_t) 1), sorted.size()) - 1];
+}
+
+/**
+ * Write one workload's results as a JSON object
+ */
+void writeResult(ostream &out, bool &first, const char *engine,
+		const char *workload, Measurement &measurement) {
+	double seconds = measurement.seconds;
+	if (seconds == 0.0) {
+		for (double nanoseconds : measurement.nanoseconds) {
+			seconds += nanoseconds / 1e9;
+		}
+	}
+	sort(measurement.nanoseconds.begin(), measurement.nanoseconds.end());
+
+	out << (first ? "" : ",") << endl;
+	out << "    { \"engine\": \"" << engine << "\", \"workload\": \""
+			<< workload << "\"";
+	out << ", \"operations\": " << measurement.operations;
+	if (measurement.searches > 0) {
+		out << ", \"hits\": " << measurement.hits;
+		out << ", \"misses\": " << measurement.searches - measurement.hits;
+	}
+	out << ", \"seconds\": " << seconds;
+	out << ", \"opsPerSecond\": "
+			<< (seconds > 0.0 ? measurement.operations / seconds : 0.0);
+	out << ", \"p50Ns\": " << percentile(measurement.nanoseconds, 0.5);
+	out << ", \"p99Ns\": " << percentile(measurement.nanoseconds, 0.99);
+	out << ", \"p999Ns\": " << percentile(measurement.nanoseconds, 0.999);
+	out << ", \"allocatedBytes\": " << allocatedBytes;
+	out << ", \"peakResidentBytes\": " << peakResidentBytes() << " }";
+	first = false;
+}
+
+/**
+ * Run every workload on one engine, in order: bulk load, lookups,
+ * churn, then full scans. The bulk load is timed as one batch, every
+ * other operation is timed on its own.
+ *
+ * @param out Stream to write the JSON results to
+ * @param first Whether no result has been written yet
+ * @param workloads Operations to run
+ */
+template<class Engine>
+void runEngine(ostream &out, bool &first, const Workloads &workloads) {
+	Engine engine;
+
+	Measurement load;
+	auto start = chrono::steady_clock::now();
+	engine.Load(workloads.bids);
+	load.nanoseconds.push_back(elapsedNanoseconds(start));
+	load.operations = workloads.bids.size();
+	load.seconds = load.nanoseconds.back() / 1e9;
+	writeResult(out, first, Engine::Name(), "bulk load", load);
+
+	Measurement uniform = measureFinds(engine, workloads.uniform);
+	writeResult(out, first, Engine::Name(), "uniform lookup", uniform);
+	Measurement zipf = measureFinds(engine, workloads.zipf);
+	writeResult(out, first, Engine::Name(), "zipf lookup", zipf);
+	Measurement hit90 = measureFinds(engine, workloads.hit90);
+	writeResult(out, first, Engine::Name(), "90% hit lookup", hit90);
+	Measurement hit50 = measureFinds(engine, workloads.hit50);
+	writeResult(out, first, Engine::Name(), "50% hit lookup", hit50);
+
+	Measurement churn;
+	for (size_t i = 0; i < workloads.churnRemove.size(); ++i) {
+		start = chrono::steady_clock::now();
+		bool removed = engine.Remove(workloads.churnRemove[i]);
+		churn.nanoseconds.push_back(elapsedNanoseconds(start));
+		churn.hits += removed;
+
+		start = chrono::steady_clock::now();
+		engine.Insert(workloads.churnInsert[i]);
+		churn.nanoseconds.push_back(elapsedNanoseconds(start));
+	}
+	churn.operations = churn.nanoseconds.size();
+	churn.searches = workloads.churnRemove.size();
+	writeResult(out, first, Engine::Name(), "insert/remove churn", churn);
+
+	Measurement scan;
+	for (unsigned int pass = 0; pass < SCAN_PASSES; ++pass) {
+		start = chrono::steady_clock::now();
+		scanSink = scanSink + engine.Scan();
+		scan.nanoseconds.push_back(elapsedNanoseconds(start));
+	}
+	scan.operations = SCAN_PASSES;
+	writeResult(out, first, Engine::Name(), "full scan", scan);
+}
+
+/**
+ * Main
+ *
+ *   Benchmark [csv path] [operations] [seed]
+ *
+ * Writes one JSON result per engine and workload to standard output.
+ * Lookups and the removes of the churn report how many found their bid.
+ * After each workload it reports the bytes the engine's structure holds
+ * and the process's peak resident memory so far, which only ever grows.
+ */
+int main(int argc, char *argv[]) {
+	string csvPath = argc >= 2 ? argv[1] : "eBid_Monthly_Sales.csv";
+	unsigned int operations = argc >= 3 ? atoi(argv[2]) : 10000;
+	unsigned long long seed = argc >= 4 ? strtoull(argv[3], nullptr, 10) : 1;
+
+	vector<Bid> bids = readBids(csvPath);
+	if (bids.empty()) {
+		cerr << "No bids read from " << csvPath << endl;
+		return 1;
+	}
+	Workloads workloads = scriptWorkloads(bids, max(operations, 1U), seed);
+	bids.clear();
+	bids.shrink_to_fit();
+
+	bool first = true;
+	cout << "{" << endl;
+	cout << "  \"csv\": ";
+	writeJsonString(cout, csvPath);
+	cout << "," << endl;
+	cout << "  \"bids\": " << workloads.bids.size() << "," << endl;
+	cout << "  \"operations\": " << operations << "," << endl;
+	cout << "  \"seed\": " << seed << "," << endl;
+	cout << "  \"results\": [";
+
+	runEngine<HashTableEngine>(cout, first, workloads);
+	runEngine<BinarySearchTreeEngine>(cout, first, workloads);
+	runEngine<LinkedListEngine>(cout, first, workloads);
+	runEngine<SortedVectorEngine>(cout, first, workloads);
+
+	cout << endl << "  ]" << endl << "}" << endl;
+
+	return 0;
+}
@@ -0,0 +1,177 @@
+/*
+ * Benchmarks the sort engines on generated bids and writes the results
+ * as JSON, so runs can be compared across machines and commits
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Bid.hpp"
+#include "BidSorting.hpp"
+
+using namespace std;
+
+// Data sets the benchmark generates, by name
+const char *const BENCHMARK_DATASETS[] = { "random", "sorted", "reversed",
+		"duplicates", "organ-pipe" };
+
+// Title words in alphabetical order, so a title spelling a number in
+// these words sorts in the order of that number
+const char *const BENCHMARK_WORDS[] = { "Antique", "Bicycle", "Cabinet",
+		"Camera", "Chair", "Desk", "Dryer", "Guitar", "Helmet", "Lamp", "Mower",
+		"Piano", "Printer", "Sofa", "Table", "Washer" };
+
+const char *const BENCHMARK_FUNDS[] = { "Cashiers Check", "Enterprise",
+		"General Fund", "Money Order" };
+
+// Words per generated title, giving 16^6 distinct titles
+const unsigned int BENCHMARK_TITLE_WORDS = 6;
+const unsigned long long BENCHMARK_KEY_SPACE = 1ULL << 24;
+
+/**
+ * Build a bid in the eBid schema from a key. Title, bid ID and amount
+ * all increase with the key, so a data set ordered by key is ordered
+ * the same way for every sort column.
+ */
+Bid benchmarkBid(unsigned long long key) {
+	Bid bid;
+	for (int word = BENCHMARK_TITLE_WORDS - 1; word >= 0; --word) {
+		bid.title += BENCHMARK_WORDS[(key >> (4 * word)) & 15];
+		if (word > 0) {
+			bid.title += ' ';
+		}
+	}
+	bid.bidId = to_string(10000 + key);
+	bid.fund = BENCHMARK_FUNDS[key % 4];
+	bid.amount = 1.0 + key / 100.0;
+	return bid;
+}
+
+/**
+ * Generate bids for one of the benchmark data sets. The same name,
+ * count and seed always give the same bids.
+ *
+ * @param dataset One of BENCHMARK_DATASETS
+ * @param count Number of bids
+ * @param seed Seed for the random data sets
+ */
+vector<Bid> generateBids(const string &dataset, unsigned int count,
+		unsigned long long seed) {
+	mt19937_64 random(seed);
+	unsigned long long step = max(1ULL, BENCHMARK_KEY_SPACE / max(1U, count));
+
+	vector<Bid> bids;
+	bids.reserve(count);
+	for (unsigned int i = 0; i < count; ++i) {
+		unsigned long long key;
+		if (dataset == "sorted") {
+			key = i * step;
+		} else if (dataset == "reversed") {
+			key = (count - 1 - i) * step;
+		} else if (dataset == "duplicates") {
+			key = (random() % 16) * (BENCHMARK_KEY_SPACE / 16);
+		} else if (dataset == "organ-pipe") {
+			key = min(i, count - 1 - i) * step;
+		} else {
+			key = random() % BENCHMARK_KEY_SPACE;
+		}
+		bids.push_back(benchmarkBid(key % BENCHMARK_KEY_SPACE));
+	}
+	return bids;
+}
+
+/**
+ * Run every sort engine over every generated data set and write the
+ * results as JSON. Each engine sorts a fresh copy repetitions times
+ * and the fastest wall clock time is kept. Comparisons and swaps come
+ * from one more, untimed run with counting switched on, which also
+ * checks the result is in order. Sorts that place bids through a
+ * permutation report the swaps it is worth. Merges, and swaps done
+ * inside the standard library, are not counted.
+ *
+ * @param out Stream to write the JSON to
+ * @param count Number of bids in each data set
+ * @param repetitions Timed runs per engine and data set
+ * @param seed Seed for the random data sets
+ */
+void runBenchmark(ostream &out, unsigned int count, unsigned int repetitions,
+		unsigned long long seed) {
+	vector<SortEngine> engines = sortEngines();
+	bool first = true;
+
+	out << "{" << endl;
+	out << "  \"size\": " << count << "," << endl;
+	out << "  \"repetitions\": " << repetitions << "," << endl;
+	out << "  \"seed\": " << seed << "," << endl;
+	out << "  \"results\": [";
+
+	for (const char *dataset : BENCHMARK_DATASETS) {
+		vector<Bid> bids = generateBids(dataset, count, seed);
+
+		for (const SortEngine &engine : engines) {
+			out << (first ? "" : ",") << endl << "    { \"dataset\": ";
+			writeJsonString(out, dataset);
+			out << ", \"engine\": ";
+			writeJsonString(out, engine.name);
+			first = false;
+
+			if (engine.sort == selectionSort && count > SELECTION_SORT_LIMIT) {
+				out << ", \"skipped\": true }";
+				continue;
+			}
+
+			double seconds = 0.0;
+			for (unsigned int run = 0; run < repetitions; ++run) {
+				vector<Bid> copy = bids;
+				auto start = chrono::steady_clock::now();
+				engine.sort(copy);
+				double elapsed = chrono::duration<double>(
+						chrono::steady_clock::now() - start).count();
+				if (run == 0 || elapsed < seconds) {
+					seconds = elapsed;
+				}
+			}
+
+			vector<Bid> copy = bids;
+			sortCounters.comparisons = 0;
+			sortCounters.swaps = 0;
+			sortCounters.enabled = true;
+			engine.sort(copy);
+			sortCounters.enabled = false;
+			bool inOrder = is_sorted(copy.begin(), copy.end(),
+					[&engine](const Bid &a, const Bid &b) {
+						return compareField(a, b, engine.field) < 0;
+					});
+
+			out << ", \"seconds\": " << seconds;
+			out << ", \"comparisons\": " << sortCounters.comparisons;
+			out << ", \"swaps\": " << sortCounters.swaps;
+			out << ", \"bidsPerSecond\": " << (seconds > 0.0 ? count / seconds : 0.0);
+			out << ", \"sorted\": " << (inOrder ? "true" : "false") << " }";
+		}
+	}
+
+	out << endl << "  ]" << endl << "}" << endl;
+}
+
+/**
+ * Main
+ *
+ * @param arg[1] number of bids in each data set (optional)
+ * @param arg[2] timed runs per engine and data set (optional)
+ * @param arg[3] seed for the random data sets (optional)
+ */
+int main(int argc, char *argv[]) {
+	unsigned int count = argc >= 2 ? atoi(argv[1]) : 100000;
+	unsigned int repetitions = argc >= 3 ? atoi(argv[2]) : 3;
+	unsigned long long seed = argc >= 4 ? strtoull(argv[3], nullptr, 10) : 1;
+
+	runBenchmark(cout, count, max(1U, repetitions), seed);
+
+	return 0;
+}
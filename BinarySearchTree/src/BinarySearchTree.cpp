@@ -6,291 +6,387 @@
 #include <iostream>
 #include <time.h>
 #include <algorithm>
-
-#include "CSVparser.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Bid.hpp"
+#include "BinarySearchTree.hpp"
+#include "ConcurrentBidMap.hpp"
+#include "FrozenBidIndex.hpp"
 
 using namespace std;
 
+typedef core::BinarySearchTree<string, Bid, BidIdOf, BidIdLess> BinarySearchTree;
+
+// Bid IDs covered by each range scan of the concurrent benchmark
+const long long RANGE_SCAN_WIDTH = 10;
+
 /**
- * Simple C function to convert a string to a double
- * after stripping out unwanted char
+ * Mixed read/write benchmark on the concurrent map for 1 to 16 threads.
+ * Each run starts from half of the bids and performs 80% searches,
+ * 9% inserts, 9% removes and 2% short range scans over all bid IDs.
  *
- * credit: http://stackoverflow.com/a/24875936
- *
- * @param ch The character to strip out
+ * @param bids The bids to run the workload with
  */
-double strToDouble(string str, char ch) {
-	str.erase(remove(str.begin(), str.end(), ch), str.end());
-	return atof(str.c_str());
-}
+void concurrentBenchmark(const vector<Bid> &bids) {
+	const int opsPerThread = 200000;
+	double baseRate = 0.0;
 
-// Structure to hold bid information
-struct Bid {
-	string bidId; // unique identifier
-	string title;
-	string fund;
-	double amount;
-	Bid() {
-		amount = 0.0;
+	if (bids.empty()) {
+		cout << "No bids loaded." << endl;
+		return;
 	}
-};
 
-// Structure for tree node
-struct Node {
-	Bid bid;
-	Node *left;
-	Node *right;
+	for (int threads = 1; threads <= 16; threads *= 2) {
+		ConcurrentBidMap map;
+		for (unsigned int i = 0; i < bids.size(); i += 2) {
+			map.Insert(bids[i]);
+		}
+
+		vector<thread> workers;
+		auto start = chrono::steady_clock::now();
+		for (int t = 0; t < threads; ++t) {
+			workers.push_back(thread([&map, &bids, t]() {
+				unsigned int seed = 2463534242u + t * 7919;
+				for (int op = 0; op < opsPerThread; ++op) {
+					seed ^= seed << 13;
+					seed ^= seed >> 17;
+					seed ^= seed << 5;
+					const Bid &bid = bids[seed % bids.size()];
+					unsigned int kind = (seed >> 24) % 100;
+					if (kind < 80) {
+						map.Search(bid.bidId);
+					} else if (kind < 89) {
+						map.Insert(bid);
+					} else if (kind < 98) {
+						map.Remove(bid.bidId);
+					} else {
+						map.Range(bid.bidId, to_string(
+								atoll(bid.bidId.c_str()) + RANGE_SCAN_WIDTH));
+					}
+				}
+			}));
+		}
+		for (auto &worker : workers) {
+			worker.join();
+		}
+		double seconds = chrono::duration<double>(
+				chrono::steady_clock::now() - start).count();
 
-	//default constructor
-	Node() {
-		left = nullptr;
-		right = nullptr;
+		double rate = threads * opsPerThread / seconds;
+		if (threads == 1) {
+			baseRate = rate;
+		}
+		cout << "threads: " << threads << " | ops/sec: " << (long long) rate
+				<< " | speedup: " << rate / baseRate << " | final size: "
+				<< map.Size() << " | unreclaimed: " << map.Retired() << endl;
 	}
-	Node(Bid aBid) :
-			Node() {
-		this->bid = aBid;
+}
+
+// Immutable node of a persistent tree, shared between versions
+struct PersistentNode;
+typedef shared_ptr<const PersistentNode> PersistentLink;
+
+struct PersistentNode {
+	const Bid bid;
+	const PersistentLink left;
+	const PersistentLink right;
+
+	PersistentNode(const Bid &aBid, const PersistentLink &aLeft,
+			const PersistentLink &aRight) :
+			bid(aBid), left(aLeft), right(aRight) {
 	}
 };
 
 /**
- * Define a class containing data members and methods to
- * implement a binary search tree
+ * Immutable view of one version of a PersistentBinarySearchTree.
+ * Readers can traverse it without locks while the tree keeps changing,
+ * and the nodes only it still uses are freed when the last copy of
+ * the snapshot is released.
  */
-class BinarySearchTree {
+class BidSnapshot {
 
 private:
-	Node *root;
-
-	void addNode(Node *node, Bid bid);
-	void inOrder(Node *node);
-	Node* removeNode(Node *node, string bidId);
+	PersistentLink root;
 
 public:
-	BinarySearchTree();
-	virtual ~BinarySearchTree();
-	void InOrder();
-	void Insert(Bid bid);
-	void Remove(string bidId);
-	Bid Search(string bidId);
+	BidSnapshot(PersistentLink root);
+	Bid Search(string bidId) const;
+	void ForEach(function<void(const Bid&)> visit) const;
 };
 
+BidSnapshot::BidSnapshot(PersistentLink root) :
+		root(root) {
+}
+
 /**
- * Display the bid information to the console (std::out)
- *
- * @param bid struct containing the bid info
+ * Search for a bid in this version
  */
-void displayBid(Bid bid) {
-	cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
-			<< bid.fund << endl;
-	return;
+Bid BidSnapshot::Search(string bidId) const {
+	const PersistentNode *current = root.get();
+
+	while (current != nullptr) {
+		if (compareBidIds(current->bid.bidId, bidId) == 0) {
+			return current->bid;
+		}
+		if (compareBidIds(current->bid.bidId, bidId) > 0) {
+			current = current->left.get();
+		} else {
+			current = current->right.get();
+		}
+	}
+
+	Bid bid;
+	return bid;
 }
 
 /**
- * Default constructor
+ * Visit every bid of this version in bidId order
  */
-BinarySearchTree::BinarySearchTree() {
-	// initialize housekeeping variables
-	root = nullptr;
+void BidSnapshot::ForEach(function<void(const Bid&)> visit) const {
+	// explicit stack, the tree is not balanced
+	vector<const PersistentNode*> stack;
+	const PersistentNode *current = root.get();
+
+	while (current != nullptr || !stack.empty()) {
+		while (current != nullptr) {
+			stack.push_back(current);
+			current = current->left.get();
+		}
+		current = stack.back();
+		stack.pop_back();
+		visit(current->bid);
+		current = current->right.get();
+	}
 }
 
 /**
- * Destructor
+ * Root of a persistent tree, loaded by readers and published by
+ * writers. With C++20 it is a std::atomic<shared_ptr>; before that a
+ * lock guards the pointer copy, never a traversal.
  */
-BinarySearchTree::~BinarySearchTree() {
-	// recurse from root deleting every node
+class PublishedRoot {
+
+private:
+#if defined(__cpp_lib_atomic_shared_ptr)
+	atomic<PersistentLink> root;
+#else
+	mutable mutex lock;
+	PersistentLink root;
+#endif
+
+public:
+	PersistentLink Load() const;
+	void Store(PersistentLink link);
+};
+
+PersistentLink PublishedRoot::Load() const {
+#if defined(__cpp_lib_atomic_shared_ptr)
+	return root.load();
+#else
+	lock_guard<mutex> guard(lock);
+	return root;
+#endif
 }
 
 /**
- * Traverse the tree in order
+ * Publish a new root. The old version is released after the swap, so
+ * freeing its nodes never holds up readers.
  */
-void BinarySearchTree::InOrder() {
-	this->inOrder(root);
+void PublishedRoot::Store(PersistentLink link) {
+#if defined(__cpp_lib_atomic_shared_ptr)
+	link = root.exchange(link);
+#else
+	lock_guard<mutex> guard(lock);
+	root.swap(link);
+#endif
 }
+
 /**
- * Insert a bid
+ * Path-copying persistent binary search tree. Insert and Remove copy
+ * only the nodes on the path to the change and publish a new root, so
+ * Snapshot() is O(1) and every snapshot stays valid and unchanged.
+ * Writers are serialized with a lock, readers never take it.
  */
-void BinarySearchTree::Insert(Bid bid) {
-	if (root == nullptr) {
-		root = new Node(bid);
-	} else {
-		this->addNode(root, bid);
-	}
+class PersistentBinarySearchTree {
+
+private:
+	PublishedRoot root;
+	mutex writeLock;
+
+	static PersistentLink build(const vector<Bid> &bids, int begin, int end);
+	static PersistentLink addNode(const PersistentLink &node, const Bid &bid);
+	static PersistentLink removeNode(const PersistentLink &node,
+			const string &bidId);
+
+public:
+	PersistentBinarySearchTree();
+	PersistentBinarySearchTree(const PersistentBinarySearchTree&) = delete;
+	PersistentBinarySearchTree &operator=(const PersistentBinarySearchTree&) =
+			delete;
+	void Build(const vector<Bid> &sortedBids);
+	void Insert(Bid bid);
+	void Remove(string bidId);
+	BidSnapshot Snapshot();
+};
 
+PersistentBinarySearchTree::PersistentBinarySearchTree() {
 }
 
 /**
- * Remove a bid
+ * Replace the contents with a balanced tree of bids sorted as in
+ * compareBidIds
  */
-void BinarySearchTree::Remove(string bidId) {
-	this->removeNode(root, bidId);
+void PersistentBinarySearchTree::Build(const vector<Bid> &sortedBids) {
+	lock_guard<mutex> guard(writeLock);
+	root.Store(build(sortedBids, 0, (int) sortedBids.size() - 1));
+}
 
+PersistentLink PersistentBinarySearchTree::build(const vector<Bid> &bids,
+		int begin, int end) {
+	if (begin > end) {
+		return nullptr;
+	}
+	int mid = begin + (end - begin) / 2;
+	return make_shared<PersistentNode>(bids[mid], build(bids, begin, mid - 1),
+			build(bids, mid + 1, end));
 }
 
 /**
- * Search for a bid
+ * Insert a bid, publishing a new version
  */
-Bid BinarySearchTree::Search(string bidId) {
-	// start searching from root
-	Node *current = root;
-
-	// loop down the BST until bid is found or bottom is reached
-	while (current != nullptr) {
-		// if match found
-		if (current->bid.bidId.compare(bidId) == 0) {
-			return current->bid;
-		}
-		// if bid is smaller than current, traverse left
-		if (current->bid.bidId.compare(bidId) > 0) {
-			current = current->left;
-		} else {
-			// else right
-			current = current->right;
-		}
-	}
+void PersistentBinarySearchTree::Insert(Bid bid) {
+	lock_guard<mutex> guard(writeLock);
+	root.Store(addNode(root.Load(), bid));
+}
 
-	Bid bid;
-	return bid;
+/**
+ * Remove a bid, publishing a new version
+ */
+void PersistentBinarySearchTree::Remove(string bidId) {
+	lock_guard<mutex> guard(writeLock);
+	root.Store(removeNode(root.Load(), bidId));
 }
 
 /**
- * Add a bid to some node (recursive)
- *
- * @param node Current node in tree
- * @param bid Bid to be added
+ * Take an O(1) snapshot of the current version
  */
-void BinarySearchTree::addNode(Node *node, Bid bid) {
-	// if node is larger than bid, add to left subtree
-	if (node->bid.bidId.compare(bid.bidId) > 0) {
-		if (node->left == nullptr) {
-			node->left = new Node(bid);
-		} else {
-			this->addNode(node->left, bid);
-		}
-	}
-	// else add to right subtree
-	else {
-		if (node->right == nullptr) {
-			node->right = new Node(bid);
-		} else {
-			this->addNode(node->right, bid);
-		}
-	}
+BidSnapshot PersistentBinarySearchTree::Snapshot() {
+	return BidSnapshot(root.Load());
 }
 
 /*
- * Recursive method to print bid information to terminal
+ * Return a copy of the path with the bid added below it
  */
-void BinarySearchTree::inOrder(Node *node) {
-
-	if (node != nullptr) {
-		// traverse down left subtree recursively
-		inOrder(node->left);
-		displayBid(node->bid);
-		// traverse right subtree as inOrder falls up from recursive calls
-		inOrder(node->right);
+PersistentLink PersistentBinarySearchTree::addNode(const PersistentLink &node,
+		const Bid &bid) {
+	if (node == nullptr) {
+		return make_shared<PersistentNode>(bid, nullptr, nullptr);
 	}
+
+	// same ordering as BinarySearchTree, equal IDs go right
+	if (compareBidIds(node->bid.bidId, bid.bidId) > 0) {
+		return make_shared<PersistentNode>(node->bid, addNode(node->left, bid),
+				node->right);
+	}
+	return make_shared<PersistentNode>(node->bid, node->left,
+			addNode(node->right, bid));
 }
 
 /*
- * Remove a node that contains a bid whose bidId matches bidKey
+ * Return a copy of the path with the bid removed, or the node itself
+ * when the bid is not in this subtree
  */
-Node* BinarySearchTree::removeNode(Node *node, string bidId) {
-	// if node is null, return
+PersistentLink PersistentBinarySearchTree::removeNode(
+		const PersistentLink &node, const string &bidId) {
 	if (node == nullptr) {
 		return node;
 	}
 
-	// recurse down left subtree
-	if (node->bid.bidId.compare(bidId) > 0) {
-		node->left = removeNode(node->left, bidId);
-	} else if (node->bid.bidId.compare(bidId) < 0) {
-		node->right = removeNode(node->right, bidId);
-	} else {
-		// node has no children (leaf node)
-		if (node->left == nullptr && node->right == nullptr) {
-			delete node;
-			node = nullptr;
-		}
-		// node has left child only
-		else if (node->left != nullptr && node->right == nullptr) {
-			Node *tempNode = node;
-			node = node->left;
-			delete tempNode;
+	if (compareBidIds(node->bid.bidId, bidId) > 0) {
+		PersistentLink left = removeNode(node->left, bidId);
+		if (left == node->left) {
+			return node;
 		}
-		// node has right child only
-		else if (node->left == nullptr && node->right != nullptr) {
-			Node *tempNode = node;
-			node = node->right;
-			delete tempNode;
-		}
-		// node has left and right children
-		else {
-			Node *tempNode = node->right;
-			while (tempNode->left != nullptr) {
-				tempNode = tempNode->left;
-			}
-			node->bid = tempNode->bid;
-			node->right = removeNode(node->right, tempNode->bid.bidId);
+		return make_shared<PersistentNode>(node->bid, left, node->right);
+	}
+	if (compareBidIds(node->bid.bidId, bidId) < 0) {
+		PersistentLink right = removeNode(node->right, bidId);
+		if (right == node->right) {
+			return node;
 		}
+		return make_shared<PersistentNode>(node->bid, node->left, right);
 	}
-	return node;
 
+	// found, splice out or replace with the smallest bid on the right
+	if (node->left == nullptr) {
+		return node->right;
+	}
+	if (node->right == nullptr) {
+		return node->left;
+	}
+	const PersistentNode *successor = node->right.get();
+	while (successor->left != nullptr) {
+		successor = successor->left.get();
+	}
+	return make_shared<PersistentNode>(successor->bid, node->left,
+			removeNode(node->right, successor->bid.bidId));
 }
 
 /**
- * Load a CSV file containing bids into a container
+ * Run a report over a snapshot while another thread keeps removing and
+ * re-inserting bids, to show the report sees one consistent version
  *
- * @param csvPath the path to the CSV file to load
- * @return a container holding all the bids read
+ * @param tree Tree to report on and update
+ * @param bids Bids in the tree, used by the updating thread
  */
-void loadBids(string csvPath, BinarySearchTree *bst) {
-	cout << "Loading CSV file " << csvPath << endl;
-
-	// initialize the CSV Parser using the given path
-	csv::Parser file = csv::Parser(csvPath);
-
-	// read and display header row - optional
-	vector<string> header = file.getHeader();
-	for (auto const &c : header) {
-		cout << c << " | ";
-	}
-	cout << "" << endl;
-
-	try {
-		// loop to read rows of a CSV file
-		for (unsigned int i = 0; i < file.rowCount(); i++) {
-
-			// Create a data structure and add to the collection of bids
-			Bid bid;
-			bid.bidId = file[i][1];
-			bid.title = file[i][0];
-			bid.fund = file[i][8];
-			bid.amount = strToDouble(file[i][4], '$');
-
-			//cout << "Item: " << bid.title << ", Fund: " << bid.fund << ", Amount: " << bid.amount << endl;
-
-			// push this bid to the end
-			bst->Insert(bid);
+void snapshotReport(PersistentBinarySearchTree &tree, const vector<Bid> &bids) {
+	BidSnapshot snapshot = tree.Snapshot();
+
+	atomic<bool> reporting(true);
+	atomic<unsigned int> updates(0);
+	thread writer([&tree, &bids, &reporting, &updates]() {
+		for (unsigned int i = 0; reporting && !bids.empty(); ++i) {
+			const Bid &bid = bids[(i * 7919) % bids.size()];
+			tree.Remove(bid.bidId);
+			tree.Insert(bid);
+			++updates;
 		}
-	} catch (csv::Error &e) {
-		std::cerr << e.what() << std::endl;
+	});
+
+	// the report only ever sees the version it started with
+	unsigned int count = 0;
+	double total = 0.0;
+	for (int pass = 0; pass < 10; ++pass) {
+		count = 0;
+		total = 0.0;
+		snapshot.ForEach([&count, &total](const Bid &bid) {
+			++count;
+			total += bid.amount;
+		});
 	}
-}
 
-void displayTime(clock_t ticks) {
-	ticks = clock() - ticks; // current clock ticks minus starting clock ticks
-	cout << "time: " << ticks << " ticks" << endl;
-	cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
-}
+	reporting = false;
+	writer.join();
 
-string getBidId() {
-
-	string bidKey;
-	cout << "Enter a bid ID" << endl;
-	cin.ignore();
-	getline(cin, bidKey);
+	cout << count << " bids totalling " << total << " in snapshot, "
+			<< updates << " updates applied meanwhile" << endl;
+}
 
-	return bidKey;
+/**
+ * Load a CSV file containing bids into a tree
+ *
+ * @param csvPath the path to the CSV file to load
+ * @param bst the tree to insert the bids read into
+ */
+void loadBids(string csvPath, BinarySearchTree *bst) {
+	for (const Bid &bid : loadBids(csvPath)) {
+		bst->Insert(bid);
+	}
 }
 
 /**
@@ -316,8 +412,17 @@ int main(int argc, char *argv[]) {
 
 	Bid bid;
 
+	unsigned int rank;
+
+	// Persistent copy of the tree for snapshot reports, built on first use
+	PersistentBinarySearchTree persistent;
+	bool persistentBuilt = false;
+
 	bst = new BinarySearchTree();
 
+	// Read-only index over a frozen copy of the tree
+	FrozenBidIndex frozen;
+
 	ticks = clock();
 	loadBids(csvPath, bst);
 	ticks = clock() - ticks; // current clock ticks minus starting clock ticks
@@ -329,6 +434,13 @@ int main(int argc, char *argv[]) {
 		cout << "  1. Display All Bids" << endl;
 		cout << "  2. Find Bid" << endl;
 		cout << "  3. Remove Bid" << endl;
+		cout << "  4. Freeze Bid Index" << endl;
+		cout << "  5. Find Bid (Frozen Index)" << endl;
+		cout << "  6. Concurrent Map Benchmark" << endl;
+		cout << "  7. Rank of Bid" << endl;
+		cout << "  8. Select Bid by Rank" << endl;
+		cout << "  10. Snapshot Report" << endl;
+		cout << "  11. Reload Benchmark (Memory)" << endl;
 		cout << "  9. Exit" << endl;
 		cout << "Enter choice: ";
 
@@ -343,7 +455,7 @@ int main(int argc, char *argv[]) {
 
 		case 1:
 			ticks = clock();
-			bst->InOrder();
+			bst->InOrder(displayBid);
 			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
 			displayTime(ticks);
 
@@ -370,6 +482,89 @@ int main(int argc, char *argv[]) {
 			// Prompt user for a bid ID and remove
 			searchValue = getBidId();
 			bst->Remove(searchValue);
+			if (persistentBuilt) {
+				persistent.Remove(searchValue);
+			}
+			break;
+
+		case 4:
+			ticks = clock();
+			frozen.Build(bst->ToVector());
+			cout << frozen.Size() << " bids frozen" << endl;
+			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+			displayTime(ticks);
+
+			break;
+
+		case 5:
+			// Prompt user for a bid ID and search the frozen copy
+			searchValue = getBidId();
+			ticks = clock();
+			bid = frozen.Search(searchValue);
+			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+
+			if (!bid.bidId.empty()) {
+				displayBid(bid);
+			} else {
+				cout << "Bid Id " << searchValue << " not found." << endl;
+			}
+
+			displayTime(ticks);
+
+			break;
+
+		case 6:
+			concurrentBenchmark(bst->ToVector());
+
+			break;
+
+		case 7:
+			// Prompt user for a bid ID and count the bids before it
+			searchValue = getBidId();
+			ticks = clock();
+			cout << bst->Rank(searchValue) << " of " << bst->Size()
+					<< " bids have a smaller bid ID" << endl;
+			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+			displayTime(ticks);
+
+			break;
+
+		case 8:
+			cout << "Enter a rank (0 is the smallest bid ID)" << endl;
+			if (!(cin >> rank)) {
+				cin.clear();
+				cin.ignore();
+				break;
+			}
+			ticks = clock();
+			bid = bst->Select(rank);
+			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+
+			if (!bid.bidId.empty()) {
+				displayBid(bid);
+			} else {
+				cout << "Rank " << rank << " out of range." << endl;
+			}
+
+			displayTime(ticks);
+
+			break;
+
+		case 10:
+			ticks = clock();
+			if (!persistentBuilt) {
+				persistent.Build(bst->ToVector());
+				persistentBuilt = true;
+			}
+			snapshotReport(persistent, bst->ToVector());
+			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+			displayTime(ticks);
+
+			break;
+
+		case 11:
+			reloadBenchmark(csvPath, *bst, &BinarySearchTree::Insert);
+
 			break;
 
 		case 9:
@@ -383,6 +578,8 @@ int main(int argc, char *argv[]) {
 		}
 	}
 
+	delete bst;
+
 	cout << "Good bye." << endl;
 
 	return 0;
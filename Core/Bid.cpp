@@ -0,0 +1,269 @@
+/*
+ * The bid helpers shared by every program
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define PSAPI_VERSION 2
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include "Bid.hpp"
+#include "CSVparser.hpp"
+
+using namespace std;
+
+/**
+ * Simple C function to convert a string to a double
+ * after stripping out unwanted char
+ *
+ * credit: http://stackoverflow.com/a/24875936
+ *
+ * @param ch The character to strip out
+ */
+double strToDouble(string str, char ch) {
+	str.erase(remove(str.begin(), str.end(), ch), str.end());
+	return atof(str.c_str());
+}
+
+/**
+ * Compare two bid IDs, shorter first, which for plain numbers is
+ * numeric order
+ *
+ * @return negative, zero or positive in the same way as string::compare
+ */
+int compareBidIds(const string &a, const string &b) {
+	if (a.size() != b.size()) {
+		return a.size() < b.size() ? -1 : 1;
+	}
+	return a.compare(b);
+}
+
+// IDs this long or longer all pack to the largest key
+const size_t PACKED_LENGTH_LIMIT = 255;
+
+/**
+ * Pack a bid ID into an integer whose ordering matches compareBidIds:
+ * the length in the top byte, then the first 7 characters
+ *
+ * @param bidId The bid ID to pack
+ */
+unsigned long long packBidId(const string &bidId) {
+	if (bidId.size() >= PACKED_LENGTH_LIMIT) {
+		return ~0ULL;
+	}
+	unsigned long long key = bidId.size();
+	for (unsigned int i = 0; i < 7; ++i) {
+		key <<= 8;
+		if (i < bidId.size()) {
+			key |= (unsigned char) bidId[i];
+		}
+	}
+	return key;
+}
+
+/**
+ * Find a column of a CSV header by name. The sample files do not share
+ * a layout (Fund is column 8 in one and column 19 in the other) and
+ * some names carry trailing spaces, so match on the trimmed name.
+ *
+ * @param header The column names of the CSV file
+ * @param name The column to find
+ * @return the column index, or -1 if the header has no such column
+ */
+int csvColumn(const vector<string> &header, const string &name) {
+	for (size_t i = 0; i < header.size(); ++i) {
+		size_t end = header[i].find_last_not_of(" \t\r");
+		if (end != string::npos && header[i].substr(0, end + 1) == name) {
+			return (int) i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Display the bid information to the console (std::out)
+ *
+ * @param bid struct containing the bid info
+ */
+void displayBid(Bid bid) {
+	cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
+			<< bid.fund << endl;
+	return;
+}
+
+/**
+ * Prompt user for bid information
+ *
+ * @return Bid struct containing the bid info
+ */
+Bid getBid() {
+	Bid bid;
+
+	cout << "Enter Id: ";
+	cin.ignore();
+	getline(cin, bid.bidId);
+
+	cout << "Enter title: ";
+	getline(cin, bid.title);
+
+	// funds such as "General Fund" have spaces, so read the whole line
+	cout << "Enter fund: ";
+	getline(cin, bid.fund);
+
+	cout << "Enter amount: ";
+	string strAmount;
+	getline(cin, strAmount);
+	bid.amount = strToDouble(strAmount, '$');
+
+	return bid;
+}
+
+/**
+ * Prompt user for a bid ID
+ *
+ * @return the bid ID entered
+ */
+string getBidId() {
+
+	string bidKey;
+	cout << "Enter a bid ID" << endl;
+	cin.ignore();
+	getline(cin, bidKey);
+
+	return bidKey;
+}
+
+/**
+ * Read the bids of a CSV file in file order
+ *
+ * @return the bids read
+ */
+vector<Bid> readBids(string csvPath) {
+	vector<Bid> bids;
+
+	// initialize the CSV Parser
+	csv::Parser file = csv::Parser(csvPath);
+
+	int fundColumn = csvColumn(file.getHeader(), "Fund");
+
+	try {
+		// Read rows of a CSV file
+		for (unsigned int i = 0; i < file.rowCount(); i++) {
+
+			// initialize a bid using data from current row (i)
+			Bid bid;
+			bid.bidId = file[i][1];
+			bid.title = file[i][0];
+			if (fundColumn >= 0) {
+				bid.fund = file[i][fundColumn];
+			}
+			bid.amount = strToDouble(file[i][4], '$');
+
+			bids.push_back(bid);
+		}
+
+	} catch (csv::Error &e) {
+		std::cerr << e.what() << std::endl;
+	}
+	return bids;
+}
+
+/**
+ * Load a CSV file containing bids, announcing it on the console
+ *
+ * @param csvPath the path to the CSV file to load
+ * @return the bids read, in file order
+ */
+vector<Bid> loadBids(string csvPath) {
+	cout << "Loading CSV file " << csvPath << endl;
+
+	return readBids(csvPath);
+}
+
+/**
+ * Write a string as a JSON string literal
+ */
+void writeJsonString(ostream &out, const string &value) {
+	out << '"';
+	for (char c : value) {
+		if (c == '"' || c == '\\') {
+			out << '\\';
+		}
+		out << c;
+	}
+	out << '"';
+}
+
+/**
+ * Display an elapsed time
+ *
+ * @param ticks clock ticks elapsed, as computed by the caller
+ */
+void displayTime(clock_t ticks) {
+	cout << "time: " << ticks << " ticks" << endl;
+	cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+}
+
+/**
+ * Resident memory of this process
+ *
+ * @return resident bytes, or 0 where the platform does not report it
+ */
+size_t residentBytes() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+			sizeof(counters))) {
+		return counters.WorkingSetSize;
+	}
+	return 0;
+#else
+	unsigned long pages = 0;
+	unsigned long resident = 0;
+	FILE *statm = fopen("/proc/self/statm", "r");
+	if (statm == nullptr) {
+		return 0;
+	}
+	if (fscanf(statm, "%lu %lu", &pages, &resident) != 2) {
+		resident = 0;
+	}
+	fclose(statm);
+	return resident * sysconf(_SC_PAGESIZE);
+#endif
+}
+
+/**
+ * Highest resident memory this process has reached so far
+ *
+ * @return peak resident bytes, or 0 where the platform does not report it
+ */
+size_t peakResidentBytes() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+			sizeof(counters))) {
+		return counters.PeakWorkingSetSize;
+	}
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+#ifdef __APPLE__
+	return usage.ru_maxrss; // bytes on macOS
+#else
+	return usage.ru_maxrss * 1024; // kilobytes elsewhere
+#endif
+#endif
+}
@@ -0,0 +1,106 @@
+/*
+ * The bid record and the helpers every program shares: parsing,
+ * loading from CSV, console input and output, and timing
+ */
+
+#ifndef CORE_BID_HPP_
+#define CORE_BID_HPP_
+
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// A structure to hold bid information
+struct Bid {
+	std::string bidId; // unique identifier
+	std::string title;
+	std::string fund;
+	double amount;
+	Bid() {
+		amount = 0.0;
+	}
+};
+
+// Key of a bid, used by the containers in Core
+struct BidIdOf {
+	const std::string &operator()(const Bid &bid) const {
+		return bid.bidId;
+	}
+};
+
+// Bid IDs are numeric, so they hash to their own value
+struct BidIdHash {
+	size_t operator()(const std::string &bidId) const {
+		return (unsigned) std::atoi(bidId.c_str());
+	}
+};
+
+double strToDouble(std::string str, char ch);
+
+int compareBidIds(const std::string &a, const std::string &b);
+
+unsigned long long packBidId(const std::string &bidId);
+
+// Bid ID ordering of compareBidIds, for the ordered containers in Core
+struct BidIdLess {
+	bool operator()(const std::string &a, const std::string &b) const {
+		return compareBidIds(a, b) < 0;
+	}
+};
+
+int csvColumn(const std::vector<std::string> &header, const std::string &name);
+
+void displayBid(Bid bid);
+
+Bid getBid();
+
+std::string getBidId();
+
+std::vector<Bid> readBids(std::string csvPath);
+
+std::vector<Bid> loadBids(std::string csvPath);
+
+void writeJsonString(std::ostream &out, const std::string &value);
+
+void displayTime(clock_t ticks);
+
+size_t residentBytes();
+
+size_t peakResidentBytes();
+
+// Reloads run by the reload benchmark, and how often it reports
+const unsigned int RELOAD_BENCHMARK_ROUNDS = 1000;
+const unsigned int RELOAD_REPORT_INTERVAL = 100;
+
+/**
+ * Clear and refill a container with the bids of a CSV file over and
+ * over, reporting resident memory as it goes. Memory should level off
+ * after the first reload instead of growing with every round.
+ *
+ * @param csvPath the path to the CSV file to load
+ * @param container Any container with a Clear() method
+ * @param add The container's method that adds one bid
+ */
+template<class Container, class Add>
+void reloadBenchmark(std::string csvPath, Container &container, Add add) {
+	std::vector<Bid> bids = readBids(csvPath);
+	std::cout << "before: " << residentBytes() / 1024 << " KB resident"
+			<< std::endl;
+
+	for (unsigned int round = 1; round <= RELOAD_BENCHMARK_ROUNDS; ++round) {
+		container.Clear();
+		for (const Bid &bid : bids) {
+			(container.*add)(bid);
+		}
+
+		if (round % RELOAD_REPORT_INTERVAL == 0) {
+			std::cout << "reload " << round << ": " << residentBytes() / 1024
+					<< " KB resident" << std::endl;
+		}
+	}
+}
+
+#endif /* CORE_BID_HPP_ */
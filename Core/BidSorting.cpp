@@ -0,0 +1,1383 @@
+/*
+ * Sort engines, multi-column sorts and the external sort for vectors
+ * of bids
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "BidSorting.hpp"
+#include "SortEngines.hpp"
+
+using namespace std;
+
+SortCounters sortCounters;
+
+inline void countComparison() {
+	if (sortCounters.enabled) {
+		sortCounters.comparisons.fetch_add(1, memory_order_relaxed);
+	}
+}
+
+inline void countSwaps(unsigned long long count) {
+	if (sortCounters.enabled) {
+		sortCounters.swaps.fetch_add(count, memory_order_relaxed);
+	}
+}
+
+/**
+ * Exchange two bids, counted for the benchmark. The sort engines in
+ * SortEngines.hpp find this overload by argument-dependent lookup.
+ */
+inline void swap(Bid &a, Bid &b) {
+	countSwaps(1);
+	std::swap(a, b); // @suppress("Invalid arguments")
+}
+
+/**
+ * Compare two titles, counted for the benchmark
+ */
+inline int compareTitles(const string &a, const string &b) {
+	countComparison();
+	return a.compare(b);
+}
+
+/**
+ * Parse a bid ID made only of digits, with no leading zeros
+ *
+ * @param bidId The bid ID to parse
+ * @param value Set to the number on success
+ * @return true if the bid ID is a plain number
+ */
+bool numericBidId(const string &bidId, unsigned long long &value) {
+	if (bidId.empty() || bidId.size() > 19
+			|| (bidId[0] == '0' && bidId.size() > 1)) {
+		return false;
+	}
+
+	value = 0;
+	for (char c : bidId) {
+		if (c < '0' || c > '9') {
+			return false;
+		}
+		value = value * 10 + (c - '0');
+	}
+	return true;
+}
+
+/**
+ * Compare two bids on a single column. Bid IDs compare as in
+ * compareBidIds.
+ *
+ * @param a First bid
+ * @param b Second bid
+ * @param field Column to compare on
+ * @return negative, zero or positive in the same way as string::compare
+ */
+int compareField(const Bid &a, const Bid &b, BidField field) {
+	countComparison();
+	switch (field) {
+	case FIELD_TITLE:
+		return a.title.compare(b.title);
+	case FIELD_FUND:
+		return a.fund.compare(b.fund);
+	case FIELD_AMOUNT:
+		return (a.amount > b.amount) - (a.amount < b.amount);
+	default:
+		return compareBidIds(a.bidId, b.bidId);
+	}
+}
+
+/**
+ * Set a single column of a bid from its text form
+ *
+ * @param bid Bid to update
+ * @param field Column to set
+ * @param value Text value, amounts may include a '$'
+ */
+void setField(Bid &bid, BidField field, string value) {
+	switch (field) {
+	case FIELD_TITLE:
+		bid.title = value;
+		break;
+	case FIELD_FUND:
+		bid.fund = value;
+		break;
+	case FIELD_AMOUNT:
+		bid.amount = strToDouble(value, '$');
+		break;
+	default:
+		bid.bidId = value;
+	}
+}
+
+/**
+ * Pack the first 8 characters of a string into an integer whose
+ * ordering matches string::compare on the prefixes
+ *
+ * @param value The string to pack
+ */
+unsigned long long packPrefix(const string &value) {
+	unsigned long long key = 0;
+	for (unsigned int i = 0; i < 8; ++i) {
+		key <<= 8;
+		if (i < value.size()) {
+			key |= (unsigned char) value[i];
+		}
+	}
+	return key;
+}
+
+// Sort entry pairing a bid's title prefix with its position
+struct TitleKey {
+	unsigned long long prefix;
+	unsigned int index;
+};
+
+/**
+ * Ordered view of the bids by title that leaves the vector untouched.
+ * A compact array of (title prefix, position) pairs is sorted instead
+ * of the bids, so most comparisons are one integer compare and only
+ * titles sharing their first 8 characters are compared as strings.
+ * Bids with equal titles keep their original order.
+ *
+ * @param bids The bids to order
+ * @return positions of the bids in title order
+ */
+vector<unsigned int> titleOrder(const vector<Bid> &bids) {
+	vector<TitleKey> keys(bids.size());
+	for (unsigned int i = 0; i < bids.size(); ++i) {
+		keys[i].prefix = packPrefix(bids[i].title);
+		keys[i].index = i;
+	}
+
+	sort(keys.begin(), keys.end(),
+			[&bids](const TitleKey &a, const TitleKey &b) {
+				countComparison();
+				if (a.prefix != b.prefix) {
+					return a.prefix < b.prefix;
+				}
+				int order = bids[a.index].title.compare(bids[b.index].title);
+				return order != 0 ? order < 0 : a.index < b.index;
+			});
+
+	vector<unsigned int> order(keys.size());
+	for (unsigned int i = 0; i < keys.size(); ++i) {
+		order[i] = keys[i].index;
+	}
+	return order;
+}
+
+/**
+ * Rearrange the bids so that bids[i] becomes the bid previously at
+ * order[i]. Each cycle of the permutation is followed once, so every
+ * bid is moved exactly once.
+ *
+ * @param bids The bids to rearrange
+ * @param order Source position for each destination
+ */
+void applyPermutation(vector<Bid> &bids, vector<unsigned int> order) {
+	for (unsigned int start = 0; start < order.size(); ++start) {
+		if (order[start] == start) {
+			continue;
+		}
+
+		Bid temp = move(bids[start]);
+		unsigned int current = start;
+		while (order[current] != start) {
+			unsigned int next = order[current];
+			bids[current] = move(bids[next]);
+			order[current] = current;
+			current = next;
+			countSwaps(1); // a cycle of length L takes L - 1 swaps
+		}
+		bids[current] = move(temp);
+		order[current] = current;
+	}
+}
+
+// Title of a bid, the key the comparison sort engines order by
+struct BidTitle {
+	const string &operator()(const Bid &bid) const {
+		return bid.title;
+	}
+};
+
+// Title ordering, counted for the benchmark
+struct TitleCompare {
+	bool operator()(const string &a, const string &b) const {
+		return compareTitles(a, b) < 0;
+	}
+};
+
+typedef core::KeyLess<BidTitle, TitleCompare> TitleLess;
+
+/**
+ * Order two bids by title
+ */
+inline bool titleLess(const Bid &a, const Bid &b) {
+	return TitleLess()(a, b);
+}
+
+/**
+ * Perform a quick sort on bid title
+ * Average performance: O(n log(n))
+ * Worst case performance O(n^2))
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ * @param begin the beginning index to sort on
+ * @param end the ending index to sort on
+ */
+void quickSort(vector<Bid> &bids, int begin, int end) {
+	core::quickSort(bids, begin, end, TitleLess());
+}
+
+/**
+ * Perform a selection sort on bid title
+ * Average performance: O(n^2))
+ * Worst case performance O(n^2))
+ *
+ * @param bid address of the vector<Bid>
+ *            instance to be sorted
+ */
+void selectionSort(vector<Bid> &bids) {
+	core::selectionSort(bids, TitleLess());
+}
+
+/**
+ * Perform an introspective sort on bid title
+ * Average performance: O(n log(n))
+ * Worst case performance O(n log(n))
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ */
+void introSort(vector<Bid> &bids) {
+	core::introSort(bids, TitleLess());
+}
+
+/**
+ * Perform a pattern-defeating quick sort on bid title over a range
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ * @param begin the beginning index to sort on
+ * @param end one past the ending index
+ */
+void pdqSortRange(vector<Bid> &bids, int begin, int end) {
+	core::pdqSortRange(bids, begin, end, TitleLess());
+}
+
+/**
+ * Perform a pattern-defeating quick sort on the whole vector
+ */
+void pdqSort(vector<Bid> &bids) {
+	pdqSortRange(bids, 0, (int) bids.size());
+}
+
+// Below this many bids the parallel sort falls back to a serial sort
+const unsigned int PARALLEL_SORT_THRESHOLD = 1 << 16;
+
+// A slice of one merge step: two sorted ranges and where their merge goes
+struct MergeTask {
+	int leftBegin, leftEnd;
+	int rightBegin, rightEnd;
+	int out;
+};
+
+/**
+ * Split point for a parallel merge: how many of the first k merged
+ * bids come from the left run. Ties go to the left run, as in a
+ * stable merge.
+ *
+ * @param k Number of merged bids before the split
+ * @return index into the left run of the split
+ */
+int mergeSplit(const vector<Bid> &bids, int k, int leftBegin, int leftEnd,
+		int rightBegin, int rightEnd) {
+	int leftSize = leftEnd - leftBegin;
+	int rightSize = rightEnd - rightBegin;
+	int low = max(0, k - rightSize);
+	int high = min(k, leftSize);
+
+	// largest i whose last left bid is not after the next right bid
+	while (low < high) {
+		int i = low + (high - low + 1) / 2;
+		if (!titleLess(bids[rightBegin + k - i], bids[leftBegin + i - 1])) {
+			low = i;
+		} else {
+			high = i - 1;
+		}
+	}
+
+	return leftBegin + low;
+}
+
+/**
+ * Fixed set of worker threads that runs batches of tasks, so a sort
+ * starts its threads once rather than once per merge round. The thread
+ * calling Run works through the batch too.
+ */
+class WorkerPool {
+
+private:
+	vector<thread> workers;
+	mutex lock;
+	condition_variable wake;
+	condition_variable done;
+	vector<function<void()> > tasks; // the batch being run
+	size_t nextTask;
+	size_t unfinished;
+	bool stopping;
+
+	void work();
+	void runNext(unique_lock<mutex> &guard);
+
+public:
+	WorkerPool(unsigned int threads);
+	virtual ~WorkerPool();
+	void Run(vector<function<void()> > batch);
+};
+
+/**
+ * Constructor
+ *
+ * @param threads Threads to run each batch on, counting the caller
+ */
+WorkerPool::WorkerPool(unsigned int threads) :
+		nextTask(0), unfinished(0), stopping(false) {
+	for (unsigned int t = 1; t < threads; ++t) {
+		workers.push_back(thread(&WorkerPool::work, this));
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		lock_guard<mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (thread &worker : workers) {
+		worker.join();
+	}
+}
+
+/**
+ * Take the next task of the batch and run it with the lock released
+ */
+void WorkerPool::runNext(unique_lock<mutex> &guard) {
+	function<void()> &task = tasks[nextTask++];
+	guard.unlock();
+	task();
+	guard.lock();
+	if (--unfinished == 0) {
+		done.notify_all();
+	}
+}
+
+void WorkerPool::work() {
+	unique_lock<mutex> guard(lock);
+	while (true) {
+		wake.wait(guard, [this]() {
+			return stopping || nextTask < tasks.size();
+		});
+		if (nextTask >= tasks.size()) {
+			return;
+		}
+		runNext(guard);
+	}
+}
+
+/**
+ * Run every task of a batch and wait for all of them to finish
+ */
+void WorkerPool::Run(vector<function<void()> > batch) {
+	unique_lock<mutex> guard(lock);
+	tasks.swap(batch);
+	nextTask = 0;
+	unfinished = tasks.size();
+	wake.notify_all();
+
+	while (nextTask < tasks.size()) {
+		runNext(guard);
+	}
+	done.wait(guard, [this]() {
+		return unfinished == 0;
+	});
+	tasks.clear();
+}
+
+/**
+ * Run the tasks of one merge round on the pool
+ */
+void runMergeTasks(WorkerPool &pool, vector<Bid> &source, vector<Bid> &target,
+		const vector<MergeTask> &tasks) {
+	vector<function<void()> > batch;
+	for (const MergeTask &task : tasks) {
+		batch.push_back([&source, &target, task]() {
+			merge(make_move_iterator(source.begin() + task.leftBegin),
+					make_move_iterator(source.begin() + task.leftEnd),
+					make_move_iterator(source.begin() + task.rightBegin),
+					make_move_iterator(source.begin() + task.rightEnd),
+					target.begin() + task.out, titleLess);
+		});
+	}
+	pool.Run(batch);
+}
+
+/**
+ * Perform a parallel merge sort on bid title with the given number
+ * of threads. Each thread pdq-sorts one slice, then sorted runs are
+ * merged pairwise, with every merge split into equal pieces so all
+ * threads stay busy down to the final merge. The threads are started
+ * once and reused by every round.
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ * @param threads Number of threads to use
+ */
+void parallelMergeSort(vector<Bid> &bids, unsigned int threads) {
+	int size = (int) bids.size();
+	if (threads < 2 || size < 2) {
+		pdqSort(bids);
+		return;
+	}
+
+	// the same threads sort the slices and run every merge round
+	WorkerPool pool(threads);
+
+	// sort one slice per thread
+	vector<int> bounds;
+	for (unsigned int t = 0; t <= threads; ++t) {
+		bounds.push_back((int) ((long long) size * t / threads));
+	}
+	vector<function<void()> > slices;
+	for (unsigned int t = 0; t < threads; ++t) {
+		int begin = bounds[t];
+		int end = bounds[t + 1];
+		slices.push_back([&bids, begin, end]() {
+			pdqSortRange(bids, begin, end);
+		});
+	}
+	pool.Run(slices);
+
+	// merge runs pairwise, moving bids back and forth with a buffer
+	vector<Bid> buffer(bids.size());
+	vector<Bid> *source = &bids;
+	vector<Bid> *target = &buffer;
+	while (bounds.size() > 2) {
+		unsigned int pairs = (bounds.size() - 1) / 2;
+		unsigned int pieces = max(1u, threads / pairs);
+		vector<MergeTask> tasks;
+		vector<int> merged;
+
+		for (unsigned int run = 0; run + 1 < bounds.size(); run += 2) {
+			int leftBegin = bounds[run];
+			int leftEnd = bounds[run + 1];
+			int rightEnd = run + 2 < bounds.size() ? bounds[run + 2] : leftEnd;
+			merged.push_back(leftBegin);
+
+			// an odd run out is carried over by tasks with no right run
+			int total = rightEnd - leftBegin;
+			int previousLeft = leftBegin;
+			int previousRight = leftEnd;
+			for (unsigned int piece = 1; piece <= pieces; ++piece) {
+				int k = (int) ((long long) total * piece / pieces);
+				int split = piece == pieces ? leftEnd :
+						mergeSplit(*source, k, leftBegin, leftEnd, leftEnd, rightEnd);
+				int rightSplit = leftEnd + k - (split - leftBegin);
+
+				MergeTask task;
+				task.leftBegin = previousLeft;
+				task.leftEnd = split;
+				task.rightBegin = previousRight;
+				task.rightEnd = rightSplit;
+				task.out = previousLeft + (previousRight - leftEnd);
+				tasks.push_back(task);
+
+				previousLeft = split;
+				previousRight = rightSplit;
+			}
+		}
+		merged.push_back(size);
+
+		runMergeTasks(pool, *source, *target, tasks);
+		swap(source, target);
+		bounds.swap(merged);
+	}
+
+	if (source != &bids) {
+		bids.swap(buffer);
+	}
+}
+
+/**
+ * Perform a parallel sort on bid title using every core, falling back
+ * to a serial sort for vectors too small to be worth the threads
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ */
+void parallelSort(vector<Bid> &bids) {
+	unsigned int threads = thread::hardware_concurrency();
+	if (bids.size() < PARALLEL_SORT_THRESHOLD || threads < 2) {
+		pdqSort(bids);
+		return;
+	}
+
+	parallelMergeSort(bids, threads);
+}
+
+/**
+ * Sort on bid title through titleOrder, moving each bid once
+ * instead of swapping bids on every exchange
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ */
+void keySort(vector<Bid> &bids) {
+	applyPermutation(bids, titleOrder(bids));
+}
+
+// Below this many bids a radix bucket is finished with insertion sort
+const int RADIX_INSERTION_THRESHOLD = 32;
+
+/**
+ * Radix digit of a title at the given depth: 0 once the title has
+ * ended, so shorter titles sort first, otherwise the byte plus one
+ */
+inline int titleDigit(const Bid &bid, size_t depth) {
+	return depth < bid.title.size() ? (unsigned char) bid.title[depth] + 1 : 0;
+}
+
+/**
+ * One level of the MSD radix sort on title: distribute the positions
+ * in order[begin..end) into 257 buckets in place (American flag sort),
+ * then sort each bucket on the next character
+ *
+ * @param depth Characters before depth are equal for the whole range
+ */
+void msdRadixSortLoop(const vector<Bid> &bids, vector<unsigned int> &order,
+		vector<unsigned short> &digits, int begin, int end, size_t depth) {
+	if (end - begin < RADIX_INSERTION_THRESHOLD) {
+		for (int i = begin + 1; i < end; ++i) {
+			unsigned int value = order[i];
+			const string &title = bids[value].title;
+			int j = i;
+			while (j > begin) {
+				countComparison();
+				if (title.compare(depth, string::npos, bids[order[j - 1]].title,
+						depth, string::npos) >= 0) {
+					break;
+				}
+				order[j] = order[j - 1];
+				--j;
+			}
+			order[j] = value;
+		}
+		return;
+	}
+
+	// read each title once per level, the digits move with the positions
+	int count[257] = { 0 };
+	for (int i = begin; i < end; ++i) {
+		digits[i] = titleDigit(bids[order[i]], depth);
+		++count[digits[i]];
+	}
+
+	int next[257];
+	int bucketEnd[257];
+	int start = begin;
+	for (int digit = 0; digit < 257; ++digit) {
+		next[digit] = start;
+		start += count[digit];
+		bucketEnd[digit] = start;
+	}
+
+	// follow each displaced position round to its bucket
+	for (int digit = 0; digit < 257; ++digit) {
+		while (next[digit] < bucketEnd[digit]) {
+			unsigned int value = order[next[digit]];
+			unsigned short valueDigit = digits[next[digit]];
+			while (valueDigit != digit) {
+				int position = next[valueDigit]++;
+				swap(value, order[position]);
+				swap(valueDigit, digits[position]);
+			}
+			digits[next[digit]] = valueDigit;
+			order[next[digit]++] = value;
+		}
+	}
+
+	// bucket 0 holds titles that have ended, which are all equal
+	for (int digit = 1; digit < 257; ++digit) {
+		int bucketBegin = bucketEnd[digit] - count[digit];
+		if (count[digit] > 1) {
+			msdRadixSortLoop(bids, order, digits, bucketBegin,
+					bucketEnd[digit], depth + 1);
+		}
+	}
+}
+
+/**
+ * Perform an MSD radix sort on bid title. Positions are distributed
+ * by one character at a time instead of comparing whole titles, and
+ * the bids are moved once at the end.
+ * Performance: O(n * k) for titles sharing k leading characters
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ */
+void msdRadixSort(vector<Bid> &bids) {
+	vector<unsigned int> order(bids.size());
+	for (unsigned int i = 0; i < order.size(); ++i) {
+		order[i] = i;
+	}
+
+	vector<unsigned short> digits(bids.size());
+	msdRadixSortLoop(bids, order, digits, 0, (int) order.size(), 0);
+	applyPermutation(bids, order);
+}
+
+/**
+ * Stable LSD radix sort of the bids on a 64-bit key per bid, a byte
+ * per pass. Passes where every key has the same byte are skipped, so
+ * small keys only pay for the bytes they use.
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ * @param keys Sort key of each bid
+ */
+void lsdRadixSort(vector<Bid> &bids, vector<unsigned long long> keys) {
+	unsigned int size = bids.size();
+	vector<unsigned int> order(size);
+	for (unsigned int i = 0; i < size; ++i) {
+		order[i] = i;
+	}
+
+	vector<unsigned long long> keysOut(size);
+	vector<unsigned int> orderOut(size);
+	for (int shift = 0; shift < 64; shift += 8) {
+		unsigned int count[256] = { 0 };
+		for (unsigned int i = 0; i < size; ++i) {
+			++count[(keys[i] >> shift) & 0xff];
+		}
+		if (size == 0 || count[(keys[0] >> shift) & 0xff] == size) {
+			continue;
+		}
+
+		unsigned int next[256];
+		unsigned int start = 0;
+		for (int digit = 0; digit < 256; ++digit) {
+			next[digit] = start;
+			start += count[digit];
+		}
+		for (unsigned int i = 0; i < size; ++i) {
+			unsigned int position = next[(keys[i] >> shift) & 0xff]++;
+			keysOut[position] = keys[i];
+			orderOut[position] = order[i];
+		}
+		keys.swap(keysOut);
+		order.swap(orderOut);
+	}
+
+	applyPermutation(bids, order);
+}
+
+/**
+ * Perform an LSD radix sort on bid amount, as whole cents
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ */
+void lsdRadixSortAmount(vector<Bid> &bids) {
+	vector<unsigned long long> keys(bids.size());
+	for (unsigned int i = 0; i < bids.size(); ++i) {
+		// flip the sign bit so negative amounts order before positive ones
+		long long cents = llround(bids[i].amount * 100.0);
+		keys[i] = (unsigned long long) cents ^ (1ULL << 63);
+	}
+
+	lsdRadixSort(bids, keys);
+}
+
+/**
+ * Perform an LSD radix sort on numeric bid ID. Falls back to a stable
+ * comparison sort if any bid ID is not a plain number.
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ */
+void lsdRadixSortBidId(vector<Bid> &bids) {
+	vector<unsigned long long> keys(bids.size());
+	for (unsigned int i = 0; i < bids.size(); ++i) {
+		if (!numericBidId(bids[i].bidId, keys[i])) {
+			stable_sort(bids.begin(), bids.end(),
+					[](const Bid &a, const Bid &b) {
+						return compareField(a, b, FIELD_BIDID) < 0;
+					});
+			return;
+		}
+	}
+
+	lsdRadixSort(bids, keys);
+}
+
+/**
+ * Parse a sort specification such as "fund ASC, amount DESC, title".
+ * Columns are bidId, title, fund or amount and default to ascending.
+ *
+ * @param spec The specification to parse
+ * @param keys Set to the parsed columns in order
+ * @return false if the specification is not valid
+ */
+bool parseSortSpec(string spec, vector<SortKey> &keys) {
+	keys.clear();
+	transform(spec.begin(), spec.end(), spec.begin(), ::tolower);
+
+	stringstream terms(spec);
+	string term;
+	while (getline(terms, term, ',')) {
+		stringstream words(term);
+		string column, direction, extra;
+		words >> column >> direction >> extra;
+
+		SortKey key;
+		if (column == "bidid" || column == "id") {
+			key.field = FIELD_BIDID;
+		} else if (column == "title") {
+			key.field = FIELD_TITLE;
+		} else if (column == "fund") {
+			key.field = FIELD_FUND;
+		} else if (column == "amount") {
+			key.field = FIELD_AMOUNT;
+		} else {
+			return false;
+		}
+
+		if (direction.empty() || direction == "asc") {
+			key.descending = false;
+		} else if (direction == "desc") {
+			key.descending = true;
+		} else {
+			return false;
+		}
+
+		if (!extra.empty()) {
+			return false;
+		}
+		keys.push_back(key);
+	}
+
+	return !keys.empty();
+}
+
+/**
+ * Encode the columns of a sort specification into one byte string so
+ * that comparing encodings byte by byte gives the specified order.
+ * Text ends with 00 00 and escapes its zero bytes as 00 FF, bid IDs
+ * are prefixed with their length, amounts are stored as big-endian
+ * bits with the sign flipped, and descending columns are inverted.
+ *
+ * @param bid The bid to encode
+ * @param keys The sort specification
+ */
+string encodeSortKey(const Bid &bid, const vector<SortKey> &keys) {
+	string encoded;
+
+	for (const SortKey &key : keys) {
+		size_t start = encoded.size();
+
+		if (key.field == FIELD_AMOUNT) {
+			unsigned long long bits;
+			memcpy(&bits, &bid.amount, sizeof(bits));
+			bits = (bits >> 63) ? ~bits : bits | (1ULL << 63);
+			for (int shift = 56; shift >= 0; shift -= 8) {
+				encoded.push_back((char) (bits >> shift));
+			}
+		} else if (key.field == FIELD_BIDID) {
+			unsigned int length = bid.bidId.size();
+			for (int shift = 24; shift >= 0; shift -= 8) {
+				encoded.push_back((char) (length >> shift));
+			}
+			encoded += bid.bidId;
+		} else {
+			const string &text = key.field == FIELD_TITLE ? bid.title : bid.fund;
+			for (char c : text) {
+				encoded.push_back(c);
+				if (c == '\0') {
+					encoded.push_back((char) 0xFF);
+				}
+			}
+			encoded.push_back('\0');
+			encoded.push_back('\0');
+		}
+
+		if (key.descending) {
+			for (size_t i = start; i < encoded.size(); ++i) {
+				encoded[i] = ~encoded[i];
+			}
+		}
+	}
+
+	return encoded;
+}
+
+// Runs shorter than this are extended with insertion sort before merging
+const int MIN_MERGE_RUN = 32;
+
+/**
+ * Stable natural merge sort (a simplified timsort). Existing ascending
+ * and strictly descending runs are found in one pass, short runs are
+ * extended with insertion sort, then neighbouring runs are merged
+ * pairwise through a buffer until one run is left.
+ *
+ * @param order The values to sort
+ * @param less Strict ordering of the values
+ */
+template<typename Less>
+void naturalMergeSort(vector<unsigned int> &order, Less less) {
+	int size = (int) order.size();
+	vector<int> bounds;
+
+	int begin = 0;
+	while (begin < size) {
+		int end = begin + 1;
+		if (end < size && less(order[end], order[begin])) {
+			// strictly descending, so reversing keeps equal values in order
+			while (end < size && less(order[end], order[end - 1])) {
+				++end;
+			}
+			reverse(order.begin() + begin, order.begin() + end);
+		} else {
+			while (end < size && !less(order[end], order[end - 1])) {
+				++end;
+			}
+		}
+
+		// extend to the minimum run length with insertion sort
+		int runEnd = min(size, max(end, begin + MIN_MERGE_RUN));
+		for (int i = end; i < runEnd; ++i) {
+			unsigned int value = order[i];
+			int j = i;
+			while (j > begin && less(value, order[j - 1])) {
+				order[j] = order[j - 1];
+				--j;
+			}
+			order[j] = value;
+		}
+
+		bounds.push_back(begin);
+		begin = runEnd;
+	}
+	bounds.push_back(size);
+
+	vector<unsigned int> buffer(size);
+	while (bounds.size() > 2) {
+		vector<int> merged;
+		for (unsigned int run = 0; run + 1 < bounds.size(); run += 2) {
+			int leftBegin = bounds[run];
+			int leftEnd = bounds[run + 1];
+			int rightEnd = run + 2 < bounds.size() ? bounds[run + 2] : leftEnd;
+			merge(order.begin() + leftBegin, order.begin() + leftEnd,
+					order.begin() + leftEnd, order.begin() + rightEnd,
+					buffer.begin() + leftBegin, less);
+			merged.push_back(leftBegin);
+		}
+		merged.push_back(size);
+
+		order.swap(buffer);
+		bounds.swap(merged);
+	}
+}
+
+/**
+ * Stable sort of the bids by a multi-column specification. Each bid's
+ * columns are encoded once, so the merge sort compares one byte string
+ * per pair instead of walking the columns.
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ * @param keys The sort specification
+ */
+void sortBySpec(vector<Bid> &bids, const vector<SortKey> &keys) {
+	vector<string> encoded(bids.size());
+	vector<unsigned int> order(bids.size());
+	for (unsigned int i = 0; i < bids.size(); ++i) {
+		encoded[i] = encodeSortKey(bids[i], keys);
+		order[i] = i;
+	}
+
+	naturalMergeSort(order, [&encoded](unsigned int a, unsigned int b) {
+		countComparison();
+		return encoded[a].compare(encoded[b]) < 0;
+	});
+
+	applyPermutation(bids, order);
+}
+
+// Top-K switches from a heap to selection once K is this fraction of n
+const unsigned int TOP_K_HEAP_DIVISOR = 16;
+
+/**
+ * Positions of the first k bids in the order of one column, without
+ * sorting the rest. Small k keeps a bounded heap of the best k seen so
+ * far, O(n log k); large k partitions with introselect (nth_element)
+ * and sorts only the first k. Equal keys keep their original order.
+ *
+ * @param bids The bids to rank, left unchanged
+ * @param k Number of bids wanted
+ * @param key Column and direction to rank by
+ * @return positions of the top k bids, best first
+ */
+vector<unsigned int> topK(const vector<Bid> &bids, unsigned int k, SortKey key) {
+	k = min(k, (unsigned int) bids.size());
+
+	auto better = [&bids, key](unsigned int a, unsigned int b) {
+		int order = compareField(bids[a], bids[b], key.field);
+		if (order != 0) {
+			return key.descending ? order > 0 : order < 0;
+		}
+		return a < b;
+	};
+
+	vector<unsigned int> best;
+	if (k == 0) {
+		return best;
+	}
+
+	if (k < bids.size() / TOP_K_HEAP_DIVISOR) {
+		// heap with the worst of the current top k on top
+		best.reserve(k);
+		for (unsigned int i = 0; i < bids.size(); ++i) {
+			if (best.size() < k) {
+				best.push_back(i);
+				push_heap(best.begin(), best.end(), better);
+			} else if (better(i, best.front())) {
+				pop_heap(best.begin(), best.end(), better);
+				best.back() = i;
+				push_heap(best.begin(), best.end(), better);
+			}
+		}
+		sort_heap(best.begin(), best.end(), better);
+	} else {
+		best.resize(bids.size());
+		for (unsigned int i = 0; i < bids.size(); ++i) {
+			best[i] = i;
+		}
+		nth_element(best.begin(), best.begin() + (k - 1), best.end(), better);
+		best.resize(k);
+		sort(best.begin(), best.end(), better);
+	}
+
+	return best;
+}
+
+// Most sorted runs merged at once, so the number of open files stays bounded
+const unsigned int EXTERNAL_MERGE_FAN_IN = 64;
+
+/**
+ * Split a CSV line into fields, with the same quote handling as
+ * csv::Parser so fields match what loadBids reads
+ *
+ * @param line The line to split
+ * @param fields Set to the fields of the line
+ */
+void splitCsvLine(const string &line, vector<string> &fields) {
+	fields.clear();
+	bool quoted = false;
+	size_t tokenStart = 0;
+
+	for (size_t i = 0; i < line.size(); ++i) {
+		if (line[i] == '"') {
+			quoted = !quoted;
+		} else if (line[i] == ',' && !quoted) {
+			fields.push_back(line.substr(tokenStart, i - tokenStart));
+			tokenStart = i + 1;
+		}
+	}
+	fields.push_back(line.substr(tokenStart));
+}
+
+// One CSV row during an external sort: its title and the row as read
+struct ExternalRecord {
+	string title;
+	string line;
+};
+
+/**
+ * Write a length-prefixed string to a binary file
+ *
+ * @throws runtime_error if the file could not take all of it
+ */
+void writeString(FILE *file, const string &value) {
+	unsigned int length = value.size();
+	if (fwrite(&length, sizeof(length), 1, file) != 1
+			|| fwrite(value.data(), 1, length, file) != length) {
+		throw runtime_error("failed to write a temporary run file");
+	}
+}
+
+/**
+ * Flush a run file written with writeString, so a full disk is
+ * reported before the run is read back
+ *
+ * @throws runtime_error if any write to the file failed
+ */
+void finishRun(FILE *file) {
+	if (fflush(file) != 0 || ferror(file)) {
+		throw runtime_error("failed to write a temporary run file");
+	}
+}
+
+/**
+ * Read a length-prefixed string from a binary file
+ *
+ * @return false at the end of the file
+ */
+bool readString(FILE *file, string &value) {
+	unsigned int length;
+	if (fread(&length, sizeof(length), 1, file) != 1) {
+		return false;
+	}
+	value.resize(length);
+	return length == 0 || fread(&value[0], 1, length, file) == length;
+}
+
+/**
+ * Sequential reader over one sorted run spilled to a temporary file
+ */
+class RunReader {
+
+private:
+	FILE *file;
+
+public:
+	ExternalRecord record;
+	bool exhausted;
+
+	RunReader(FILE *file);
+	void Next();
+};
+
+RunReader::RunReader(FILE *file) {
+	this->file = file;
+	rewind(file);
+	exhausted = false;
+	Next();
+}
+
+/**
+ * Advance to the next record of the run
+ */
+void RunReader::Next() {
+	exhausted = !readString(file, record.title)
+			|| !readString(file, record.line);
+}
+
+/**
+ * Tournament tree of losers for a k-way merge. Each internal node
+ * keeps the run that lost the match played there, so replacing the
+ * winner replays only the matches on its path: log k comparisons
+ * per record instead of k.
+ */
+class LoserTree {
+
+private:
+	vector<RunReader> &runs;
+	vector<unsigned int> tree; // tree[0] is the winner
+	unsigned int minusInfinity; // virtual run that wins every match
+
+	bool beats(unsigned int a, unsigned int b);
+
+public:
+	LoserTree(vector<RunReader> &runs);
+	void Replay(unsigned int run);
+	unsigned int Winner();
+	bool Empty();
+};
+
+LoserTree::LoserTree(vector<RunReader> &runs) :
+		runs(runs) {
+	minusInfinity = runs.size();
+	tree.assign(runs.size(), minusInfinity);
+	for (unsigned int run = runs.size(); run-- > 0;) {
+		Replay(run);
+	}
+}
+
+/**
+ * True if run a's record comes first, finished runs lose every match
+ * and ties go to the earlier run so the merge is stable
+ */
+bool LoserTree::beats(unsigned int a, unsigned int b) {
+	if (a == minusInfinity || b == minusInfinity) {
+		return a == minusInfinity;
+	}
+	if (runs[a].exhausted || runs[b].exhausted) {
+		return !runs[a].exhausted;
+	}
+	int order = runs[a].record.title.compare(runs[b].record.title);
+	return order != 0 ? order < 0 : a < b;
+}
+
+/**
+ * Replay the matches from a run's leaf to the root after it advanced
+ */
+void LoserTree::Replay(unsigned int run) {
+	unsigned int winner = run;
+	for (unsigned int node = (run + runs.size()) / 2; node > 0; node /= 2) {
+		if (beats(tree[node], winner)) {
+			swap(tree[node], winner);
+		}
+	}
+	tree[0] = winner;
+}
+
+unsigned int LoserTree::Winner() {
+	return tree[0];
+}
+
+bool LoserTree::Empty() {
+	return runs.empty() || runs[tree[0]].exhausted;
+}
+
+/**
+ * Sort one run in memory by title and spill it to a temporary file
+ *
+ * @return the temporary file, removed automatically when closed
+ */
+FILE* spillRun(vector<ExternalRecord> &records) {
+	stable_sort(records.begin(), records.end(),
+			[](const ExternalRecord &a, const ExternalRecord &b) {
+				return a.title.compare(b.title) < 0;
+			});
+
+	FILE *file = tmpfile();
+	if (file == nullptr) {
+		throw runtime_error("could not create a temporary run file");
+	}
+	try {
+		for (const ExternalRecord &record : records) {
+			writeString(file, record.title);
+			writeString(file, record.line);
+		}
+		finishRun(file);
+	} catch (runtime_error&) {
+		fclose(file);
+		throw;
+	}
+	records.clear();
+	return file;
+}
+
+/**
+ * Merge sorted run files with a loser tree, handing each record to
+ * output in title order
+ */
+void mergeRuns(vector<FILE*> &files,
+		function<void(const ExternalRecord&)> output) {
+	vector<RunReader> runs;
+	for (FILE *file : files) {
+		runs.push_back(RunReader(file));
+	}
+
+	LoserTree tree(runs);
+	while (!tree.Empty()) {
+		unsigned int winner = tree.Winner();
+		output(runs[winner].record);
+		runs[winner].Next();
+		tree.Replay(winner);
+	}
+
+	for (FILE *file : files) {
+		fclose(file);
+	}
+	files.clear();
+}
+
+/**
+ * Sort a CSV file of bids by title without loading it into memory.
+ * Rows are read in runs of about memoryBytes, each run is sorted and
+ * spilled to a temporary file, and the runs are k-way merged into the
+ * output. Runs beyond the merge fan-in are first merged in groups.
+ *
+ * The CSV output is the input rows, header first, in title order.
+ * The binary output is one record per bid: length-prefixed bidId,
+ * title and fund strings followed by the amount as a double.
+ *
+ * @param csvPath the path to the CSV file to sort
+ * @param outputPath the path to write the sorted bids to
+ * @param memoryBytes memory to use for each in-memory run
+ * @param binaryOutput write binary records instead of CSV
+ * @return false if the sort failed
+ */
+bool externalSort(string csvPath, string outputPath, size_t memoryBytes,
+		bool binaryOutput) {
+	ifstream input(csvPath.c_str());
+	if (!input.is_open()) {
+		cerr << "Failed to open " << csvPath << endl;
+		return false;
+	}
+
+	string header;
+	getline(input, header);
+	vector<string> fields;
+	splitCsvLine(header, fields);
+	size_t columns = fields.size();
+	int fundColumn = csvColumn(fields, "Fund");
+
+	vector<FILE*> files;
+	unsigned int runCount = 0;
+	unsigned long long rows = 0;
+	try {
+		// read, sort and spill memory-bounded runs
+		vector<ExternalRecord> records;
+		size_t runBytes = 0;
+		ExternalRecord record;
+		while (getline(input, record.line)) {
+			if (record.line.empty()) {
+				continue;
+			}
+			splitCsvLine(record.line, fields);
+			if (fields.size() != columns) {
+				throw runtime_error("corrupted data in row " + to_string(rows + 1));
+			}
+			record.title = fields[0];
+			runBytes += record.title.size() + record.line.size()
+					+ sizeof(ExternalRecord);
+			records.push_back(record);
+			++rows;
+
+			if (runBytes >= memoryBytes) {
+				files.push_back(spillRun(records));
+				++runCount;
+				runBytes = 0;
+			}
+		}
+		if (!records.empty() || files.empty()) {
+			files.push_back(spillRun(records));
+			++runCount;
+		}
+
+		// merge groups of runs until one merge can take them all. Each
+		// merged run takes its group's place, so runs stay in row order
+		// and the loser tree's ties still keep the sort stable.
+		while (files.size() > EXTERNAL_MERGE_FAN_IN) {
+			size_t merges = 0;
+			for (size_t first = 0; first < files.size();
+					first += EXTERNAL_MERGE_FAN_IN) {
+				size_t last = min(first + EXTERNAL_MERGE_FAN_IN, files.size());
+				if (last - first == 1) {
+					files[merges++] = files[first];
+					continue;
+				}
+
+				// the group owns its runs until they are merged and closed
+				vector<FILE*> group(files.begin() + first, files.begin() + last);
+				fill(files.begin() + first, files.begin() + last, nullptr);
+
+				FILE *merged = tmpfile();
+				try {
+					if (merged == nullptr) {
+						throw runtime_error(
+								"could not create a temporary run file");
+					}
+					mergeRuns(group, [merged](const ExternalRecord &record) {
+						writeString(merged, record.title);
+						writeString(merged, record.line);
+					});
+					finishRun(merged);
+				} catch (runtime_error&) {
+					for (FILE *file : group) {
+						fclose(file);
+					}
+					if (merged != nullptr) {
+						fclose(merged);
+					}
+					throw;
+				}
+				files[merges++] = merged;
+			}
+			files.resize(merges);
+		}
+
+		ofstream output(outputPath.c_str(),
+				binaryOutput ? ios::out | ios::binary : ios::out);
+		if (!output.is_open()) {
+			throw runtime_error("failed to open " + outputPath);
+		}
+
+		if (binaryOutput) {
+			mergeRuns(files,
+					[&output, &fields, fundColumn](const ExternalRecord &record) {
+				splitCsvLine(record.line, fields);
+				string values[] = { fields[1], fields[0],
+						fundColumn >= 0 ? fields[fundColumn] : string() };
+				for (const string &value : values) {
+					unsigned int length = value.size();
+					output.write((const char*) &length, sizeof(length));
+					output.write(value.data(), length);
+				}
+				double amount = strToDouble(fields[4], '$');
+				output.write((const char*) &amount, sizeof(amount));
+			});
+		} else {
+			output << header << endl;
+			mergeRuns(files, [&output](const ExternalRecord &record) {
+				output << record.line << '\n';
+			});
+		}
+
+		output.close();
+		if (output.fail()) {
+			throw runtime_error("failed to write " + outputPath);
+		}
+	} catch (runtime_error &e) {
+		for (FILE *file : files) {
+			if (file != nullptr) {
+				fclose(file);
+			}
+		}
+		cerr << e.what() << endl;
+		return false;
+	}
+
+	cout << rows << " bids sorted in " << runCount << " runs" << endl;
+	return true;
+}
+
+/**
+ * Sort with the standard library, as a baseline for the other engines
+ */
+void standardSort(vector<Bid> &bids) {
+	sort(bids.begin(), bids.end(), titleLess);
+}
+
+/**
+ * Quick sort the whole vector, for use from the sort engine table
+ */
+void quickSortAll(vector<Bid> &bids) {
+	quickSort(bids, 0, (int) bids.size() - 1);
+}
+
+/**
+ * All sort algorithms available from the menu
+ */
+vector<SortEngine> sortEngines() {
+	vector<SortEngine> engines = {
+		{ "Selection Sort", FIELD_TITLE, selectionSort },
+		{ "Quick Sort", FIELD_TITLE, quickSortAll },
+		{ "Introsort", FIELD_TITLE, introSort },
+		{ "Pattern-Defeating Quick Sort", FIELD_TITLE, pdqSort },
+		{ "Title Key Sort", FIELD_TITLE, keySort },
+		{ "Parallel Merge Sort", FIELD_TITLE, parallelSort },
+		{ "MSD Radix Sort", FIELD_TITLE, msdRadixSort },
+		{ "LSD Radix Sort (Amount)", FIELD_AMOUNT, lsdRadixSortAmount },
+		{ "LSD Radix Sort (Bid ID)", FIELD_BIDID, lsdRadixSortBidId },
+		{ "std::sort", FIELD_TITLE, standardSort }
+	};
+	return engines;
+}
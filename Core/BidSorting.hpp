@@ -0,0 +1,102 @@
+/*
+ * Sort engines, multi-column sorts and the external sort for vectors
+ * of bids, shared by the Vector program, the sort benchmark and the
+ * tests
+ */
+
+#ifndef CORE_BIDSORTING_HPP_
+#define CORE_BIDSORTING_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Bid.hpp"
+
+// Bid columns that can be indexed or sorted on
+enum BidField {
+	FIELD_BIDID, FIELD_TITLE, FIELD_FUND, FIELD_AMOUNT
+};
+
+// Operation counts for the benchmark, only collected while enabled
+struct SortCounters {
+	bool enabled;
+	std::atomic<unsigned long long> comparisons;
+	std::atomic<unsigned long long> swaps;
+	SortCounters() :
+			enabled(false), comparisons(0), swaps(0) {
+	}
+};
+
+extern SortCounters sortCounters;
+
+// One column of a sort specification
+struct SortKey {
+	BidField field;
+	bool descending;
+};
+
+// A sort algorithm that can be picked from the menu
+struct SortEngine {
+	std::string name;
+	BidField field; // column the bids end up ordered by
+	void (*sort)(std::vector<Bid> &bids);
+};
+
+// Selection sort is skipped above this many bids when comparing engines
+const unsigned int SELECTION_SORT_LIMIT = 20000;
+
+bool numericBidId(const std::string &bidId, unsigned long long &value);
+
+int compareField(const Bid &a, const Bid &b, BidField field);
+
+void setField(Bid &bid, BidField field, std::string value);
+
+std::vector<unsigned int> titleOrder(const std::vector<Bid> &bids);
+
+void applyPermutation(std::vector<Bid> &bids, std::vector<unsigned int> order);
+
+void quickSort(std::vector<Bid> &bids, int begin, int end);
+
+void quickSortAll(std::vector<Bid> &bids);
+
+void selectionSort(std::vector<Bid> &bids);
+
+void introSort(std::vector<Bid> &bids);
+
+void pdqSortRange(std::vector<Bid> &bids, int begin, int end);
+
+void pdqSort(std::vector<Bid> &bids);
+
+void parallelMergeSort(std::vector<Bid> &bids, unsigned int threads);
+
+void parallelSort(std::vector<Bid> &bids);
+
+void keySort(std::vector<Bid> &bids);
+
+void msdRadixSort(std::vector<Bid> &bids);
+
+void lsdRadixSortAmount(std::vector<Bid> &bids);
+
+void lsdRadixSortBidId(std::vector<Bid> &bids);
+
+void standardSort(std::vector<Bid> &bids);
+
+std::vector<SortEngine> sortEngines();
+
+bool parseSortSpec(std::string spec, std::vector<SortKey> &keys);
+
+std::string encodeSortKey(const Bid &bid, const std::vector<SortKey> &keys);
+
+void sortBySpec(std::vector<Bid> &bids, const std::vector<SortKey> &keys);
+
+std::vector<unsigned int> topK(const std::vector<Bid> &bids, unsigned int k,
+		SortKey key);
+
+void splitCsvLine(const std::string &line, std::vector<std::string> &fields);
+
+bool externalSort(std::string csvPath, std::string outputPath,
+		size_t memoryBytes, bool binaryOutput);
+
+#endif /* CORE_BIDSORTING_HPP_ */
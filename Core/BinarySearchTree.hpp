@@ -0,0 +1,438 @@
+/*
+ * Binary search tree shared by the programs, parameterized on the value
+ * type, how its key is pulled out (KeyOf), the key ordering and the
+ * allocator the nodes come from. The tree is kept AVL balanced, and
+ * every node counts the nodes below it, so inserts, removes, rank and
+ * select queries all run in O(log n) even when keys arrive in order.
+ */
+
+#ifndef CORE_BINARYSEARCHTREE_HPP_
+#define CORE_BINARYSEARCHTREE_HPP_
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace core {
+
+template<class Key, class Value, class KeyOf, class Compare = std::less<Key>,
+		class Alloc = std::allocator<Value> >
+class BinarySearchTree {
+
+private:
+	// Structure for tree node
+	struct Node {
+		Value value;
+		Node *left;
+		Node *right;
+		unsigned int size; // number of nodes in this subtree
+		int height; // levels in this subtree, 1 for a leaf
+
+		Node(const Value &aValue) :
+				value(aValue), left(nullptr), right(nullptr), size(1), height(1) {
+		}
+	};
+
+	typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Node> NodeAlloc;
+	typedef std::allocator_traits<NodeAlloc> NodeTraits;
+
+	Node *root;
+	NodeAlloc allocator;
+	KeyOf keyOf;
+	Compare less;
+
+	Node* newNode(const Value &value);
+	void deleteNode(Node *node);
+	Node* insertNode(Node *node, const Value &value);
+	Node* removeNode(Node *node, const Key &key, bool &removed);
+	Node* removeMin(Node *node, Node *&min);
+	static unsigned int sizeOf(const Node *node);
+	static int heightOf(const Node *node);
+	static void update(Node *node);
+	static Node* rotateLeft(Node *node);
+	static Node* rotateRight(Node *node);
+	static Node* rebalance(Node *node);
+
+public:
+	BinarySearchTree(const Alloc &alloc = Alloc());
+	virtual ~BinarySearchTree();
+	// a copy would share the root, and the destructors would free it twice
+	BinarySearchTree(const BinarySearchTree&) = delete;
+	BinarySearchTree &operator=(const BinarySearchTree&) = delete;
+	template<class Visit>
+	void InOrder(Visit visit) const;
+	void Insert(const Value &value);
+	bool Remove(const Key &key);
+	const Value* Find(const Key &key) const;
+	Value Search(const Key &key) const;
+	std::vector<Value> ToVector() const;
+	unsigned int Rank(const Key &key) const;
+	Value Select(unsigned int rank) const;
+	unsigned int Size() const;
+	void Clear();
+};
+
+/**
+ * Default constructor
+ *
+ * @param alloc Allocator the nodes are taken from
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::BinarySearchTree(
+		const Alloc &alloc) :
+		root(nullptr), allocator(alloc) {
+}
+
+/**
+ * Destructor
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::~BinarySearchTree() {
+	Clear();
+}
+
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+typename BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::Node* BinarySearchTree<
+		Key, Value, KeyOf, Compare, Alloc>::newNode(const Value &value) {
+	Node *node = NodeTraits::allocate(allocator, 1);
+	NodeTraits::construct(allocator, node, value);
+	return node;
+}
+
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+void BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::deleteNode(Node *node) {
+	NodeTraits::destroy(allocator, node);
+	NodeTraits::deallocate(allocator, node, 1);
+}
+
+/**
+ * Delete every node without recursion. A left child is rotated up
+ * until the current node has none, then the node is deleted and the
+ * walk moves right, so even a tree degenerated into a list is freed
+ * in O(n) time with no stack.
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+void BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::Clear() {
+	Node *node = root;
+	while (node != nullptr) {
+		if (node->left != nullptr) {
+			Node *left = node->left;
+			node->left = left->right;
+			left->right = node;
+			node = left;
+		} else {
+			Node *right = node->right;
+			deleteNode(node);
+			node = right;
+		}
+	}
+	root = nullptr;
+}
+
+/**
+ * Traverse the tree in order with an explicit stack
+ *
+ * @param visit Called with each value in key order
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+template<class Visit>
+void BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::InOrder(
+		Visit visit) const {
+	std::vector<const Node*> stack;
+	const Node *current = root;
+
+	while (current != nullptr || !stack.empty()) {
+		// walk down the left spine, then visit and step right
+		while (current != nullptr) {
+			stack.push_back(current);
+			current = current->left;
+		}
+		current = stack.back();
+		stack.pop_back();
+		visit(current->value);
+		current = current->right;
+	}
+}
+
+/**
+ * Insert a value. Equal keys go to the right, after the values
+ * already in the tree; rotations keep that order.
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+void BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::Insert(
+		const Value &value) {
+	root = insertNode(root, value);
+}
+
+/**
+ * Remove a value with the given key
+ *
+ * @return true if a value was removed
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+bool BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::Remove(const Key &key) {
+	bool removed = false;
+	root = removeNode(root, key, removed);
+	return removed;
+}
+
+/**
+ * Find a value
+ *
+ * @return the value, or nullptr if no value has the key
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+const Value* BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::Find(
+		const Key &key) const {
+	// start searching from root
+	const Node *current = root;
+
+	// loop down the tree until the key is found or bottom is reached
+	while (current != nullptr) {
+		if (less(key, keyOf(current->value))) {
+			current = current->left;
+		} else if (less(keyOf(current->value), key)) {
+			current = current->right;
+		} else {
+			return &current->value;
+		}
+	}
+
+	return nullptr;
+}
+
+/**
+ * Search for a value
+ *
+ * @return a copy of the value, or a default constructed one if not found
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+Value BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::Search(
+		const Key &key) const {
+	const Value *value = Find(key);
+	return value != nullptr ? *value : Value();
+}
+
+/*
+ * Number of nodes in a subtree, 0 for an empty one
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+unsigned int BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::sizeOf(
+		const Node *node) {
+	return node == nullptr ? 0 : node->size;
+}
+
+/*
+ * Height of a subtree, 0 for an empty one
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+int BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::heightOf(
+		const Node *node) {
+	return node == nullptr ? 0 : node->height;
+}
+
+/*
+ * Recompute a node's size and height from its children
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+void BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::update(Node *node) {
+	node->size = 1 + sizeOf(node->left) + sizeOf(node->right);
+	node->height = 1 + std::max(heightOf(node->left), heightOf(node->right));
+}
+
+/*
+ * Lift the right child over the node, returning the new subtree root
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+typename BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::Node* BinarySearchTree<
+		Key, Value, KeyOf, Compare, Alloc>::rotateLeft(Node *node) {
+	Node *right = node->right;
+	node->right = right->left;
+	right->left = node;
+	update(node);
+	update(right);
+	return right;
+}
+
+/*
+ * Lift the left child over the node, returning the new subtree root
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+typename BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::Node* BinarySearchTree<
+		Key, Value, KeyOf, Compare, Alloc>::rotateRight(Node *node) {
+	Node *left = node->left;
+	node->left = left->right;
+	left->right = node;
+	update(node);
+	update(left);
+	return left;
+}
+
+/*
+ * Restore the AVL property at a node whose subtrees differ in height
+ * by at most two, returning the new subtree root
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+typename BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::Node* BinarySearchTree<
+		Key, Value, KeyOf, Compare, Alloc>::rebalance(Node *node) {
+	update(node);
+	int balance = heightOf(node->left) - heightOf(node->right);
+
+	if (balance > 1) {
+		if (heightOf(node->left->left) < heightOf(node->left->right)) {
+			node->left = rotateLeft(node->left);
+		}
+		return rotateRight(node);
+	}
+	if (balance < -1) {
+		if (heightOf(node->right->right) < heightOf(node->right->left)) {
+			node->right = rotateRight(node->right);
+		}
+		return rotateLeft(node);
+	}
+	return node;
+}
+
+/*
+ * Insert a value below a node, returning the new subtree root
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+typename BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::Node* BinarySearchTree<
+		Key, Value, KeyOf, Compare, Alloc>::insertNode(Node *node,
+		const Value &value) {
+	if (node == nullptr) {
+		return newNode(value);
+	}
+
+	if (less(keyOf(value), keyOf(node->value))) {
+		node->left = insertNode(node->left, value);
+	} else {
+		node->right = insertNode(node->right, value);
+	}
+	return rebalance(node);
+}
+
+/**
+ * Count the values whose key is less than the given one
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+unsigned int BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::Rank(
+		const Key &key) const {
+	unsigned int rank = 0;
+	const Node *current = root;
+
+	while (current != nullptr) {
+		// this node and its left subtree are all smaller
+		if (less(keyOf(current->value), key)) {
+			rank += 1 + sizeOf(current->left);
+			current = current->right;
+		} else {
+			current = current->left;
+		}
+	}
+
+	return rank;
+}
+
+/**
+ * Find the value with the given rank in key order, so that
+ * Select(Rank(key)) returns that value
+ *
+ * @param rank 0 for the smallest key
+ * @return the value, or a default constructed one if rank is out of range
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+Value BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::Select(
+		unsigned int rank) const {
+	const Node *current = root;
+
+	while (current != nullptr) {
+		unsigned int leftSize = sizeOf(current->left);
+		if (rank < leftSize) {
+			current = current->left;
+		} else if (rank == leftSize) {
+			return current->value;
+		} else {
+			rank -= leftSize + 1;
+			current = current->right;
+		}
+	}
+
+	return Value();
+}
+
+/**
+ * Number of values in the tree
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+unsigned int BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::Size() const {
+	return sizeOf(root);
+}
+
+/**
+ * Copy all values into a vector sorted by key
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+std::vector<Value> BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::ToVector() const {
+	std::vector<Value> values;
+	values.reserve(Size());
+	InOrder([&values](const Value &value) {
+		values.push_back(value);
+	});
+	return values;
+}
+
+/*
+ * Remove a node whose key matches, returning the new subtree root
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+typename BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::Node* BinarySearchTree<
+		Key, Value, KeyOf, Compare, Alloc>::removeNode(Node *node, const Key &key,
+		bool &removed) {
+	if (node == nullptr) {
+		return node;
+	}
+
+	if (less(key, keyOf(node->value))) {
+		node->left = removeNode(node->left, key, removed);
+	} else if (less(keyOf(node->value), key)) {
+		node->right = removeNode(node->right, key, removed);
+	} else if (node->left == nullptr || node->right == nullptr) {
+		// zero or one child, which takes the node's place
+		Node *child = node->left != nullptr ? node->left : node->right;
+		deleteNode(node);
+		node = child;
+		removed = true;
+	} else {
+		// two children, the smallest node on the right takes the place
+		Node *successor;
+		Node *right = removeMin(node->right, successor);
+		successor->left = node->left;
+		successor->right = right;
+		deleteNode(node);
+		node = successor;
+		removed = true;
+	}
+
+	// keep sizes, heights and balance correct on the way back up
+	return node != nullptr ? rebalance(node) : node;
+}
+
+/*
+ * Unlink the smallest node of a subtree, returning the new subtree root
+ */
+template<class Key, class Value, class KeyOf, class Compare, class Alloc>
+typename BinarySearchTree<Key, Value, KeyOf, Compare, Alloc>::Node* BinarySearchTree<
+		Key, Value, KeyOf, Compare, Alloc>::removeMin(Node *node, Node *&min) {
+	if (node->left == nullptr) {
+		min = node;
+		return node->right;
+	}
+	node->left = removeMin(node->left, min);
+	return rebalance(node);
+}
+
+} // namespace core
+
+#endif /* CORE_BINARYSEARCHTREE_HPP_ */
@@ -0,0 +1,360 @@
+/*
+ * Lazy skip list bid map with epoch-based reclamation
+ */
+
+#include <functional>
+#include <thread>
+
+#include "ConcurrentBidMap.hpp"
+
+using namespace std;
+
+ConcurrentBidMap::ConcurrentBidMap() {
+	// head sentinel is fully linked and sorts before every bid
+	head = new Node(Bid(), SKIPLIST_MAX_LEVEL);
+	head->fullyLinked = true;
+	size = 0;
+
+	epoch = 1;
+	for (unsigned int slot = 0; slot < EPOCH_SLOTS; ++slot) {
+		active[slot].store(0);
+	}
+	retired = nullptr;
+	retiredCount = 0;
+	retiresSinceReclaim = 0;
+}
+
+/**
+ * Claim an idle slot and announce the current epoch in it, so nodes
+ * retired from now on outlive this operation
+ */
+ConcurrentBidMap::EpochGuard::EpochGuard(ConcurrentBidMap &map) :
+		map(map) {
+	static thread_local unsigned int start = hash<thread::id>()(
+			this_thread::get_id());
+
+	while (true) {
+		for (unsigned int i = 0; i < EPOCH_SLOTS; ++i) {
+			slot = (start + i) % EPOCH_SLOTS;
+			unsigned long idle = 0;
+			if (map.active[slot].load(memory_order_relaxed) == 0
+					&& map.active[slot].compare_exchange_strong(idle,
+							map.epoch.load())) {
+				return;
+			}
+		}
+		this_thread::yield();
+	}
+}
+
+ConcurrentBidMap::EpochGuard::~EpochGuard() {
+	map.active[slot].store(0, memory_order_release);
+}
+
+/**
+ * Queue an unlinked node to be freed once no running operation can
+ * still be standing on it
+ */
+void ConcurrentBidMap::retire(Node *node) {
+	lock_guard<mutex> guard(retiredLock);
+	node->retireEpoch = epoch.load();
+	node->retiredNext = retired;
+	retired = node;
+	++retiredCount;
+
+	if (++retiresSinceReclaim >= RECLAIM_INTERVAL) {
+		retiresSinceReclaim = 0;
+		reclaim();
+	}
+}
+
+/**
+ * Advance the epoch and free the retired nodes every running operation
+ * started after. Called with retiredLock held.
+ */
+void ConcurrentBidMap::reclaim() {
+	unsigned long oldest = epoch.fetch_add(1) + 1;
+	for (unsigned int slot = 0; slot < EPOCH_SLOTS; ++slot) {
+		unsigned long announced = active[slot].load();
+		if (announced != 0 && announced < oldest) {
+			oldest = announced;
+		}
+	}
+
+	Node **link = &retired;
+	while (*link != nullptr) {
+		Node *node = *link;
+		if (node->retireEpoch < oldest) {
+			*link = node->retiredNext;
+			delete node;
+			--retiredCount;
+		} else {
+			link = &node->retiredNext;
+		}
+	}
+}
+
+/**
+ * Destructor, must not run while other threads still use the map
+ */
+ConcurrentBidMap::~ConcurrentBidMap() {
+	Node *node = head;
+	while (node != nullptr) {
+		Node *next = node->next[0].load();
+		delete node;
+		node = next;
+	}
+
+	node = retired;
+	while (node != nullptr) {
+		Node *next = node->retiredNext;
+		delete node;
+		node = next;
+	}
+}
+
+/**
+ * Geometric tower height (p = 1/2) from a per-thread generator
+ */
+int ConcurrentBidMap::randomLevel() {
+	static thread_local unsigned int seed = hash<thread::id>()(
+			this_thread::get_id()) | 1;
+
+	// xorshift32
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+
+	int level = 1;
+	unsigned int bits = seed;
+	while ((bits & 1) && level < SKIPLIST_MAX_LEVEL) {
+		++level;
+		bits >>= 1;
+	}
+	return level;
+}
+
+/**
+ * Find the predecessor and successor of a bidId on every level
+ *
+ * @return the highest level the bid was found on, or -1
+ */
+int ConcurrentBidMap::find(const string &bidId, Node *preds[], Node *succs[]) {
+	int found = -1;
+	Node *pred = head;
+
+	for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; --level) {
+		Node *curr = pred->next[level].load(memory_order_acquire);
+		while (curr != nullptr && compareBidIds(curr->bid.bidId, bidId) < 0) {
+			pred = curr;
+			curr = pred->next[level].load(memory_order_acquire);
+		}
+		if (found == -1 && curr != nullptr
+				&& compareBidIds(curr->bid.bidId, bidId) == 0) {
+			found = level;
+		}
+		preds[level] = pred;
+		succs[level] = curr;
+	}
+
+	return found;
+}
+
+/**
+ * Unlock the predecessors locked for levels 0 to highestLocked,
+ * a node that is the predecessor on several levels is locked once
+ */
+void ConcurrentBidMap::unlockPreds(Node *preds[], int highestLocked) {
+	Node *prevPred = nullptr;
+	for (int level = 0; level <= highestLocked; ++level) {
+		if (preds[level] != prevPred) {
+			preds[level]->lock.unlock();
+			prevPred = preds[level];
+		}
+	}
+}
+
+/**
+ * Insert a bid unless its bidId is already present
+ *
+ * @return true if the bid was inserted
+ */
+bool ConcurrentBidMap::Insert(Bid bid) {
+	EpochGuard guard(*this);
+	int topLevel = randomLevel();
+	Node *preds[SKIPLIST_MAX_LEVEL];
+	Node *succs[SKIPLIST_MAX_LEVEL];
+
+	while (true) {
+		int found = find(bid.bidId, preds, succs);
+		if (found != -1) {
+			Node *nodeFound = succs[found];
+			if (!nodeFound->marked) {
+				// wait for a concurrent insert of the same bid to finish
+				while (!nodeFound->fullyLinked) {
+					this_thread::yield();
+				}
+				return false;
+			}
+			// being removed, retry until it is unlinked
+			continue;
+		}
+
+		// lock predecessors bottom up and check nothing changed
+		int highestLocked = -1;
+		Node *prevPred = nullptr;
+		bool valid = true;
+		for (int level = 0; valid && level < topLevel; ++level) {
+			Node *pred = preds[level];
+			Node *succ = succs[level];
+			if (pred != prevPred) {
+				pred->lock.lock();
+				prevPred = pred;
+			}
+			highestLocked = level;
+			valid = !pred->marked && (succ == nullptr || !succ->marked)
+					&& pred->next[level].load() == succ;
+		}
+		if (!valid) {
+			unlockPreds(preds, highestLocked);
+			continue;
+		}
+
+		Node *newNode = new Node(bid, topLevel);
+		for (int level = 0; level < topLevel; ++level) {
+			newNode->next[level].store(succs[level], memory_order_relaxed);
+		}
+		for (int level = 0; level < topLevel; ++level) {
+			preds[level]->next[level].store(newNode, memory_order_release);
+		}
+		newNode->fullyLinked = true;
+
+		unlockPreds(preds, highestLocked);
+		++size;
+		return true;
+	}
+}
+
+/**
+ * Remove a bid
+ *
+ * @return true if this call removed the bid
+ */
+bool ConcurrentBidMap::Remove(string bidId) {
+	EpochGuard guard(*this);
+	Node *victim = nullptr;
+	bool isMarked = false;
+	int topLevel = -1;
+	Node *preds[SKIPLIST_MAX_LEVEL];
+	Node *succs[SKIPLIST_MAX_LEVEL];
+
+	while (true) {
+		int found = find(bidId, preds, succs);
+		if (found != -1) {
+			victim = succs[found];
+		}
+
+		if (!isMarked
+				&& (found == -1 || !victim->fullyLinked
+						|| victim->topLevel - 1 != found || victim->marked)) {
+			return false;
+		}
+
+		// logically remove by marking, under the victim's lock
+		if (!isMarked) {
+			topLevel = victim->topLevel;
+			victim->lock.lock();
+			if (victim->marked) {
+				victim->lock.unlock();
+				return false;
+			}
+			victim->marked = true;
+			isMarked = true;
+		}
+
+		// lock predecessors bottom up and check they still point at victim
+		int highestLocked = -1;
+		Node *prevPred = nullptr;
+		bool valid = true;
+		for (int level = 0; valid && level < topLevel; ++level) {
+			Node *pred = preds[level];
+			if (pred != prevPred) {
+				pred->lock.lock();
+				prevPred = pred;
+			}
+			highestLocked = level;
+			valid = !pred->marked && pred->next[level].load() == victim;
+		}
+		if (!valid) {
+			unlockPreds(preds, highestLocked);
+			continue;
+		}
+
+		// physically unlink from the top down
+		for (int level = topLevel - 1; level >= 0; --level) {
+			preds[level]->next[level].store(victim->next[level].load(),
+					memory_order_release);
+		}
+		victim->lock.unlock();
+		unlockPreds(preds, highestLocked);
+
+		// retire the node, readers may still be standing on it
+		retire(victim);
+
+		--size;
+		return true;
+	}
+}
+
+/**
+ * Search for a bid without taking any locks
+ *
+ * @return the bid, or an empty bid if not found
+ */
+Bid ConcurrentBidMap::Search(string bidId) {
+	EpochGuard guard(*this);
+	Node *preds[SKIPLIST_MAX_LEVEL];
+	Node *succs[SKIPLIST_MAX_LEVEL];
+
+	int found = find(bidId, preds, succs);
+	if (found != -1 && succs[found]->fullyLinked && !succs[found]->marked) {
+		return succs[found]->bid;
+	}
+
+	Bid bid;
+	return bid;
+}
+
+/**
+ * Collect the bids with fromBidId <= bidId <= toBidId in order. The scan
+ * takes no locks, so it sees each bid that stayed present throughout.
+ */
+vector<Bid> ConcurrentBidMap::Range(string fromBidId, string toBidId) {
+	EpochGuard guard(*this);
+	Node *preds[SKIPLIST_MAX_LEVEL];
+	Node *succs[SKIPLIST_MAX_LEVEL];
+	vector<Bid> bids;
+
+	find(fromBidId, preds, succs);
+	Node *node = succs[0];
+	while (node != nullptr && compareBidIds(node->bid.bidId, toBidId) <= 0) {
+		if (node->fullyLinked && !node->marked) {
+			bids.push_back(node->bid);
+		}
+		node = node->next[0].load(memory_order_acquire);
+	}
+
+	return bids;
+}
+
+int ConcurrentBidMap::Size() {
+	return size;
+}
+
+/**
+ * Removed nodes not yet freed
+ */
+unsigned int ConcurrentBidMap::Retired() {
+	lock_guard<mutex> guard(retiredLock);
+	return retiredCount;
+}
@@ -0,0 +1,106 @@
+/*
+ * Ordered bid map that many threads can search and update at once
+ */
+
+#ifndef CORE_CONCURRENTBIDMAP_HPP_
+#define CORE_CONCURRENTBIDMAP_HPP_
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Bid.hpp"
+
+// Highest tower in the concurrent skip list, enough for ~16M bids
+const int SKIPLIST_MAX_LEVEL = 24;
+
+// Operations that can run on the concurrent map at once, more wait
+const unsigned int EPOCH_SLOTS = 64;
+
+// Removes between attempts to free retired nodes
+const unsigned int RECLAIM_INTERVAL = 64;
+
+/**
+ * Bid map, ordered as in compareBidIds, that can be shared between
+ * threads (lazy skip list).
+ * Search and range scans take no locks: they walk the towers and skip
+ * nodes that are not fully linked or are marked as removed. Insert and
+ * Remove lock only the predecessors they change, validate them, and
+ * retry if another writer got there first.
+ *
+ * Readers may still be walking a removed node, so removed nodes are
+ * reclaimed by epoch: every operation announces the global epoch in a
+ * slot while it runs, and a node retired in an epoch is freed once
+ * every running operation announced a later one. A thread stalled in
+ * the middle of an operation holds back every node retired since it
+ * started, so memory stays bounded only while operations finish.
+ */
+class ConcurrentBidMap {
+
+private:
+	struct Node {
+		Bid bid;
+		int topLevel;
+		std::mutex lock;
+		std::atomic<bool> marked;
+		std::atomic<bool> fullyLinked;
+		std::atomic<Node*> *next;
+		Node *retiredNext;
+		unsigned long retireEpoch;
+
+		Node(Bid aBid, int aTopLevel) :
+				bid(aBid), topLevel(aTopLevel), marked(false), fullyLinked(
+						false), retiredNext(nullptr), retireEpoch(0) {
+			next = new std::atomic<Node*> [topLevel];
+			for (int level = 0; level < topLevel; ++level) {
+				next[level].store(nullptr);
+			}
+		}
+
+		~Node() {
+			delete[] next;
+		}
+	};
+
+	// Announces the epoch for the length of one operation
+	class EpochGuard {
+	private:
+		ConcurrentBidMap &map;
+		unsigned int slot;
+	public:
+		EpochGuard(ConcurrentBidMap &map);
+		~EpochGuard();
+	};
+
+	Node *head;
+	std::atomic<int> size;
+
+	std::atomic<unsigned long> epoch; // starts at 1, 0 marks an idle slot
+	std::atomic<unsigned long> active[EPOCH_SLOTS];
+	std::mutex retiredLock; // guards the fields below
+	Node *retired;
+	unsigned int retiredCount;
+	unsigned int retiresSinceReclaim;
+
+	int find(const std::string &bidId, Node *preds[], Node *succs[]);
+	void unlockPreds(Node *preds[], int highestLocked);
+	int randomLevel();
+	void retire(Node *node);
+	void reclaim();
+
+public:
+	ConcurrentBidMap();
+	virtual ~ConcurrentBidMap();
+	// the map owns its nodes, so copies would free them twice
+	ConcurrentBidMap(const ConcurrentBidMap&) = delete;
+	ConcurrentBidMap &operator=(const ConcurrentBidMap&) = delete;
+	bool Insert(Bid bid);
+	bool Remove(std::string bidId);
+	Bid Search(std::string bidId);
+	std::vector<Bid> Range(std::string fromBidId, std::string toBidId);
+	int Size();
+	unsigned int Retired();
+};
+
+#endif /* CORE_CONCURRENTBIDMAP_HPP_ */
@@ -0,0 +1,143 @@
+/*
+ * Eytzinger-layout bid ID index shared by the programs
+ */
+
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#if defined(_M_X64) || defined(_M_IX86)
+#include <xmmintrin.h>
+#endif
+#endif
+
+#include "FrozenBidIndex.hpp"
+
+using namespace std;
+
+/**
+ * Hint that an address will be read soon. Only a hint, so compilers
+ * without a prefetch intrinsic simply skip it.
+ *
+ * @param address The address to fetch into cache
+ */
+static inline void prefetch(const void *address) {
+#if defined(__GNUC__)
+	__builtin_prefetch(address);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	_mm_prefetch((const char*) address, _MM_HINT_T0);
+#else
+	(void) address;
+#endif
+}
+
+/**
+ * Count the zero bits below the lowest set bit
+ *
+ * @param value A non-zero value
+ */
+static inline unsigned int countTrailingZeros(unsigned long long value) {
+#if defined(__GNUC__)
+	return __builtin_ctzll(value);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return index;
+#else
+	unsigned int count = 0;
+	while ((value & 1) == 0) {
+		value >>= 1;
+		++count;
+	}
+	return count;
+#endif
+}
+
+FrozenBidIndex::FrozenBidIndex() {
+}
+
+/**
+ * Build the index from a set of bids, sorting them by bidId first
+ * if they are not already in that order
+ *
+ * @param sortedBids The bids to index
+ */
+void FrozenBidIndex::Build(vector<Bid> sortedBids) {
+	auto byBidId = [](const Bid &a, const Bid &b) {
+		return compareBidIds(a.bidId, b.bidId) < 0;
+	};
+	if (!is_sorted(sortedBids.begin(), sortedBids.end(), byBidId)) {
+		stable_sort(sortedBids.begin(), sortedBids.end(), byBidId);
+	}
+
+	bids.swap(sortedBids);
+	keys.assign(bids.size() + 1, 0);
+	ranks.assign(bids.size() + 1, 0);
+
+	unsigned int next = 0;
+	layout(next, 1);
+}
+
+/**
+ * Fill the Eytzinger array with an in-order walk of the implicit tree
+ *
+ * @param next Position of the next sorted bid to place
+ * @param slot Current slot, children of slot k are 2k and 2k+1
+ */
+void FrozenBidIndex::layout(unsigned int &next, unsigned int slot) {
+	if (slot <= bids.size()) {
+		layout(next, 2 * slot);
+		keys[slot] = packBidId(bids[next].bidId);
+		ranks[slot] = next++;
+		layout(next, 2 * slot + 1);
+	}
+}
+
+/**
+ * Release the indexed bids
+ */
+void FrozenBidIndex::Clear() {
+	vector<unsigned long long>().swap(keys);
+	vector<unsigned int>().swap(ranks);
+	vector<Bid>().swap(bids);
+}
+
+/**
+ * Search for a bid, returns an empty bid if not found
+ *
+ * @param bidId The bid id to search for
+ */
+Bid FrozenBidIndex::Search(string bidId) {
+	unsigned long long key = packBidId(bidId);
+	unsigned long long slot = 1;
+	unsigned long long n = bids.size();
+
+	// branch-free descent, the comparison result picks the child
+	while (slot <= n) {
+		prefetch(keys.data() + slot * 8);
+		slot = 2 * slot + (keys[slot] < key);
+	}
+
+	// undo the right turns taken after the last left turn, which leaves
+	// the slot of the first key not less than the one searched for
+	slot >>= countTrailingZeros(~slot) + 1;
+	if (slot == 0) {
+		Bid bid;
+		return bid;
+	}
+
+	// IDs longer than 7 characters can share a packed key
+	for (unsigned int i = ranks[slot];
+			i < bids.size() && packBidId(bids[i].bidId) == key; ++i) {
+		if (bids[i].bidId.compare(bidId) == 0) {
+			return bids[i];
+		}
+	}
+
+	Bid bid;
+	return bid;
+}
+
+unsigned int FrozenBidIndex::Size() {
+	return bids.size();
+}
@@ -0,0 +1,37 @@
+/*
+ * Read-only bid ID index for bid sets that are loaded once and then
+ * only queried
+ */
+
+#ifndef CORE_FROZENBIDINDEX_HPP_
+#define CORE_FROZENBIDINDEX_HPP_
+
+#include <string>
+#include <vector>
+
+#include "Bid.hpp"
+
+/**
+ * Read-only search index over bid IDs, ordered as in compareBidIds.
+ * Packed keys are stored in Eytzinger (breadth first) order, so a
+ * search walks an implicit tree with no pointers and prefetches the
+ * cache line holding the descendants three levels down.
+ */
+class FrozenBidIndex {
+
+private:
+	std::vector<unsigned long long> keys; // Eytzinger order, slot 0 unused
+	std::vector<unsigned int> ranks;      // Eytzinger slot -> position in bids
+	std::vector<Bid> bids;                // in compareBidIds order
+
+	void layout(unsigned int &next, unsigned int slot);
+
+public:
+	FrozenBidIndex();
+	void Build(std::vector<Bid> sortedBids);
+	void Clear();
+	Bid Search(std::string bidId);
+	unsigned int Size();
+};
+
+#endif /* CORE_FROZENBIDINDEX_HPP_ */
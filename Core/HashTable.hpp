@@ -0,0 +1,263 @@
+/*
+ * Chained hash table shared by the programs, parameterized on the value
+ * type, how its key is pulled out (KeyOf), the hasher, the key equality
+ * and the allocator the nodes come from
+ */
+
+#ifndef CORE_HASHTABLE_HPP_
+#define CORE_HASHTABLE_HPP_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace core {
+
+// Buckets of a table built without a size
+const unsigned int DEFAULT_BUCKETS = 179;
+
+template<class Key, class Value, class KeyOf, class Hash = std::hash<Key>,
+		class Equal = std::equal_to<Key>, class Alloc = std::allocator<Value> >
+class HashTable {
+
+private:
+	// Node for hash table/linked list for collisions
+	struct Node {
+		Value value;
+		bool used; // bucket heads are empty until the first insert
+		Node *next;
+
+		Node() :
+				value(), used(false), next(nullptr) {
+		}
+
+		Node(const Value &aValue) :
+				value(aValue), used(true), next(nullptr) {
+		}
+	};
+
+	typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Node> NodeAlloc;
+	typedef std::allocator_traits<NodeAlloc> NodeTraits;
+
+	// bucket heads live in the vector, collisions are chained behind them
+	std::vector<Node, NodeAlloc> nodes;
+	NodeAlloc allocator;
+	KeyOf keyOf;
+	Hash hasher;
+	Equal equal;
+	size_t count;
+
+	unsigned int bucket(const Key &key) const;
+	Node* newNode(const Value &value);
+	void deleteNode(Node *node);
+
+public:
+	HashTable(unsigned int size = DEFAULT_BUCKETS, const Alloc &alloc = Alloc());
+	virtual ~HashTable();
+	// the buckets own their nodes, so copying would free them twice
+	HashTable(const HashTable&) = delete;
+	HashTable &operator=(const HashTable&) = delete;
+	void Insert(const Value &value);
+	bool Remove(const Key &key);
+	const Value* Find(const Key &key) const;
+	Value Search(const Key &key) const;
+	size_t Size() const;
+	unsigned int BucketCount() const;
+	void Clear();
+	template<class Visit>
+	void ForEach(Visit visit) const;
+};
+
+/**
+ * Constructor
+ *
+ * @param size Number of buckets
+ * @param alloc Allocator the nodes are taken from
+ */
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+HashTable<Key, Value, KeyOf, Hash, Equal, Alloc>::HashTable(unsigned int size,
+		const Alloc &alloc) :
+		nodes(size == 0 ? 1 : size, Node(), NodeAlloc(alloc)), allocator(alloc), count(0) {
+}
+
+/**
+ * Destructor
+ */
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+HashTable<Key, Value, KeyOf, Hash, Equal, Alloc>::~HashTable() {
+	Clear();
+}
+
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+typename HashTable<Key, Value, KeyOf, Hash, Equal, Alloc>::Node* HashTable<Key,
+		Value, KeyOf, Hash, Equal, Alloc>::newNode(const Value &value) {
+	Node *node = NodeTraits::allocate(allocator, 1);
+	NodeTraits::construct(allocator, node, value);
+	return node;
+}
+
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+void HashTable<Key, Value, KeyOf, Hash, Equal, Alloc>::deleteNode(Node *node) {
+	NodeTraits::destroy(allocator, node);
+	NodeTraits::deallocate(allocator, node, 1);
+}
+
+/**
+ * Bucket a key hashes to
+ */
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+unsigned int HashTable<Key, Value, KeyOf, Hash, Equal, Alloc>::bucket(
+		const Key &key) const {
+	return hasher(key) % nodes.size();
+}
+
+/**
+ * Remove every value. The chained nodes of each bucket are freed in
+ * one walk and the bucket heads are reset in place so the table keeps
+ * its size.
+ */
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+void HashTable<Key, Value, KeyOf, Hash, Equal, Alloc>::Clear() {
+	for (Node &head : nodes) {
+		Node *node = head.next;
+		while (node != nullptr) {
+			Node *next = node->next;
+			deleteNode(node);
+			node = next;
+		}
+		head = Node();
+	}
+	count = 0;
+}
+
+/**
+ * Insert a value at the end of its bucket's chain
+ *
+ * @param value The value to insert
+ */
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+void HashTable<Key, Value, KeyOf, Hash, Equal, Alloc>::Insert(const Value &value) {
+	Node *node = &nodes[bucket(keyOf(value))];
+
+	if (!node->used) {
+		node->value = value;
+		node->used = true;
+	} else {
+		// find the next open node (last one)
+		while (node->next != nullptr) {
+			node = node->next;
+		}
+		node->next = newNode(value);
+	}
+	++count;
+}
+
+/**
+ * Remove the first value with a key
+ *
+ * @param key The key to search for
+ * @return true if a value was removed
+ */
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+bool HashTable<Key, Value, KeyOf, Hash, Equal, Alloc>::Remove(const Key &key) {
+	Node *node = &nodes[bucket(key)];
+	if (!node->used) {
+		return false;
+	}
+
+	// the bucket head lives in the vector, so pull the next node into it
+	if (equal(keyOf(node->value), key)) {
+		Node *next = node->next;
+		if (next != nullptr) {
+			node->value = std::move(next->value);
+			node->next = next->next;
+			deleteNode(next);
+		} else {
+			*node = Node();
+		}
+		--count;
+		return true;
+	}
+
+	// walk linked list to unlink and free the match
+	Node *previous = node;
+	node = node->next;
+	while (node != nullptr) {
+		if (equal(keyOf(node->value), key)) {
+			previous->next = node->next;
+			deleteNode(node);
+			--count;
+			return true;
+		}
+		previous = node;
+		node = node->next;
+	}
+	return false;
+}
+
+/**
+ * Find the first value with a key
+ *
+ * @param key The key to search for
+ * @return the value, or nullptr if there is none
+ */
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+const Value* HashTable<Key, Value, KeyOf, Hash, Equal, Alloc>::Find(
+		const Key &key) const {
+	const Node *node = &nodes[bucket(key)];
+	if (!node->used) {
+		return nullptr;
+	}
+
+	while (node != nullptr) {
+		if (equal(keyOf(node->value), key)) {
+			return &node->value;
+		}
+		node = node->next;
+	}
+	return nullptr;
+}
+
+/**
+ * Search for a key
+ *
+ * @param key The key to search for
+ * @return a copy of the value, or a default constructed one if not found
+ */
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+Value HashTable<Key, Value, KeyOf, Hash, Equal, Alloc>::Search(
+		const Key &key) const {
+	const Value *value = Find(key);
+	return value != nullptr ? *value : Value();
+}
+
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+size_t HashTable<Key, Value, KeyOf, Hash, Equal, Alloc>::Size() const {
+	return count;
+}
+
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+unsigned int HashTable<Key, Value, KeyOf, Hash, Equal, Alloc>::BucketCount() const {
+	return nodes.size();
+}
+
+/**
+ * Visit every value in bucket order
+ *
+ * @param visit Called with the bucket number and the value
+ */
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+template<class Visit>
+void HashTable<Key, Value, KeyOf, Hash, Equal, Alloc>::ForEach(Visit visit) const {
+	for (unsigned int key = 0; key < nodes.size(); ++key) {
+		for (const Node *node = &nodes[key]; node != nullptr && node->used;
+				node = node->next) {
+			visit(key, node->value);
+		}
+	}
+}
+
+} // namespace core
+
+#endif /* CORE_HASHTABLE_HPP_ */
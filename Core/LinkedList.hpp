@@ -0,0 +1,356 @@
+/*
+ * Singly linked list shared by the programs, parameterized on the value
+ * type, how its key is pulled out (KeyOf), the hasher and key equality
+ * of the optional index, and the allocator the nodes come from
+ */
+
+#ifndef CORE_LINKEDLIST_HPP_
+#define CORE_LINKEDLIST_HPP_
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+namespace core {
+
+// How LinkedList::Find reorders the list after a hit
+enum SearchOrder {
+	SEARCH_FIXED, // leave the list as it is
+	SEARCH_MOVE_TO_FRONT, // move the value found to the head
+	SEARCH_TRANSPOSE // swap the value found with the one before it
+};
+
+template<class Key, class Value, class KeyOf, class Hash = std::hash<Key>,
+		class Equal = std::equal_to<Key>, class Alloc = std::allocator<Value> >
+class LinkedList {
+
+private:
+	// Defines node in singly-linked list, consisting of a value and next pointer
+	struct Node {
+		Value value;
+		Node *next;
+
+		Node(const Value &aValue) :
+				value(aValue), next(nullptr) {
+		}
+	};
+
+	typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Node> NodeAlloc;
+	typedef std::allocator_traits<NodeAlloc> NodeTraits;
+	typedef typename std::allocator_traits<Alloc>::template rebind_alloc<
+			std::pair<const Key, Node*> > IndexAlloc;
+
+	Node *head;
+	Node *tail;
+	int size;
+	NodeAlloc allocator;
+	KeyOf keyOf;
+	Equal equal;
+
+	// Optional index from key to the node before that key's node,
+	// nullptr for the head, so a value can be unlinked without a scan
+	bool indexed;
+	std::unordered_map<Key, Node*, Hash, Equal, IndexAlloc> index;
+
+	// Self-organizing search, so frequently searched values drift to the head
+	SearchOrder searchOrder;
+	unsigned long long nodesVisited;
+
+	Node* newNode(const Value &value);
+	void deleteNode(Node *node);
+	Node* nodeAfter(Node *previous) const;
+	bool replaceIndexed(const Value &value);
+
+public:
+	LinkedList(bool indexed = false, const Alloc &alloc = Alloc());
+	virtual ~LinkedList();
+	// nodes (and the index into them) belong to one list only
+	LinkedList(const LinkedList&) = delete;
+	LinkedList &operator=(const LinkedList&) = delete;
+	void Append(const Value &value);
+	void Prepend(const Value &value);
+	bool Remove(const Key &key);
+	const Value* Find(const Key &key);
+	Value Search(const Key &key);
+	int Size() const;
+	void Clear();
+	template<class Visit>
+	void ForEach(Visit visit) const;
+	void SetSearchOrder(SearchOrder order);
+	unsigned long long NodesVisited() const;
+};
+
+/**
+ * Constructor
+ *
+ * @param indexed keep a hash index of keys, so Find and Remove take
+ *                O(1) and adding a value whose key is already in the
+ *                list replaces that value in place
+ * @param alloc Allocator the nodes are taken from
+ */
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+LinkedList<Key, Value, KeyOf, Hash, Equal, Alloc>::LinkedList(bool indexed,
+		const Alloc &alloc) :
+		head(nullptr), tail(nullptr), size(0), allocator(alloc), indexed(indexed),
+		index(0, Hash(), Equal(), IndexAlloc(alloc)), searchOrder(SEARCH_FIXED),
+		nodesVisited(0) {
+}
+
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+LinkedList<Key, Value, KeyOf, Hash, Equal, Alloc>::~LinkedList() {
+	Clear();
+}
+
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+typename LinkedList<Key, Value, KeyOf, Hash, Equal, Alloc>::Node* LinkedList<Key,
+		Value, KeyOf, Hash, Equal, Alloc>::newNode(const Value &value) {
+	Node *node = NodeTraits::allocate(allocator, 1);
+	NodeTraits::construct(allocator, node, value);
+	return node;
+}
+
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+void LinkedList<Key, Value, KeyOf, Hash, Equal, Alloc>::deleteNode(Node *node) {
+	NodeTraits::destroy(allocator, node);
+	NodeTraits::deallocate(allocator, node, 1);
+}
+
+// The node following previous, or the head when previous is nullptr
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+typename LinkedList<Key, Value, KeyOf, Hash, Equal, Alloc>::Node* LinkedList<Key,
+		Value, KeyOf, Hash, Equal, Alloc>::nodeAfter(Node *previous) const {
+	return previous == nullptr ? head : previous->next;
+}
+
+// Overwrite the value with the same key in an indexed list, if there is one
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+bool LinkedList<Key, Value, KeyOf, Hash, Equal, Alloc>::replaceIndexed(
+		const Value &value) {
+	auto found = index.find(keyOf(value));
+	if (found == index.end()) {
+		return false;
+	}
+	nodeAfter(found->second)->value = value;
+	return true;
+}
+
+// Append a new value to the end of the list
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+void LinkedList<Key, Value, KeyOf, Hash, Equal, Alloc>::Append(const Value &value) {
+	if (indexed) {
+		if (replaceIndexed(value)) {
+			return;
+		}
+		index[keyOf(value)] = tail;
+	}
+
+	Node *node = newNode(value);
+	if (head == nullptr) {
+		head = node;
+	} else {
+		tail->next = node;
+	}
+
+	// new node is now the tail
+	tail = node;
+
+	++size;
+}
+
+// Prepend a new value to the start of the list
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+void LinkedList<Key, Value, KeyOf, Hash, Equal, Alloc>::Prepend(const Value &value) {
+	if (indexed) {
+		if (replaceIndexed(value)) {
+			return;
+		}
+		index[keyOf(value)] = nullptr;
+	}
+
+	Node *node = newNode(value);
+
+	// if a head node exists, set new node next ptr to current head
+	if (head != nullptr) {
+		node->next = head;
+		if (indexed) {
+			index[keyOf(head->value)] = node;
+		}
+	} else {
+		tail = node;
+	}
+
+	head = node;
+
+	++size;
+}
+
+/**
+ * Remove the first value with a key
+ *
+ * @param key The key to remove from the list
+ * @return true if a value was removed
+ */
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+bool LinkedList<Key, Value, KeyOf, Hash, Equal, Alloc>::Remove(const Key &key) {
+	Node *previous = nullptr;
+	Node *curNode = head;
+
+	if (indexed) {
+		auto found = index.find(key);
+		if (found == index.end()) {
+			return false;
+		}
+		previous = found->second;
+		curNode = nodeAfter(previous);
+		index.erase(found);
+	} else {
+		// Iterate the whole linked list, remembering the node before
+		while (curNode != nullptr && !equal(keyOf(curNode->value), key)) {
+			previous = curNode;
+			curNode = curNode->next;
+		}
+		if (curNode == nullptr) {
+			return false;
+		}
+	}
+
+	// transfer pointers to skip node
+	Node *nextNode = curNode->next;
+	if (previous == nullptr) {
+		head = nextNode;
+	} else {
+		previous->next = nextNode;
+	}
+	if (tail == curNode) {
+		tail = previous;
+	}
+	if (indexed && nextNode != nullptr) {
+		index[keyOf(nextNode->value)] = previous;
+	}
+
+	deleteNode(curNode);
+
+	--size;
+	return true;
+}
+
+/**
+ * Find the first value with a key, reordering the list as chosen
+ * with SetSearchOrder
+ *
+ * @param key The key to search for
+ * @return the value, or nullptr if there is none
+ */
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+const Value* LinkedList<Key, Value, KeyOf, Hash, Equal, Alloc>::Find(
+		const Key &key) {
+
+	if (indexed) {
+		auto found = index.find(key);
+		return found != index.end() ? &nodeAfter(found->second)->value : nullptr;
+	}
+
+	Node *beforePrevious = nullptr;
+	Node *previous = nullptr;
+	Node *curNode = head;
+
+	// Iterate the whole linked list
+	while (curNode != nullptr) {
+		++nodesVisited;
+
+		// Sought value found
+		if (equal(keyOf(curNode->value), key)) {
+			if (previous != nullptr && searchOrder == SEARCH_MOVE_TO_FRONT) {
+				previous->next = curNode->next;
+				curNode->next = head;
+				head = curNode;
+				if (tail == curNode) {
+					tail = previous;
+				}
+			} else if (previous != nullptr && searchOrder == SEARCH_TRANSPOSE) {
+				previous->next = curNode->next;
+				curNode->next = previous;
+				if (beforePrevious == nullptr) {
+					head = curNode;
+				} else {
+					beforePrevious->next = curNode;
+				}
+				if (tail == curNode) {
+					tail = previous;
+				}
+			}
+			return &curNode->value;
+		}
+
+		// Continue iterating
+		beforePrevious = previous;
+		previous = curNode;
+		curNode = curNode->next;
+	}
+
+	return nullptr;
+}
+
+/**
+ * Search for a key
+ *
+ * @return a copy of the value, or a default constructed one if not found
+ */
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+Value LinkedList<Key, Value, KeyOf, Hash, Equal, Alloc>::Search(const Key &key) {
+	const Value *value = Find(key);
+	return value != nullptr ? *value : Value();
+}
+
+// Returns the current size (number of elements) in the list
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+int LinkedList<Key, Value, KeyOf, Hash, Equal, Alloc>::Size() const {
+	return size;
+}
+
+// Delete every node, walking the list once
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+void LinkedList<Key, Value, KeyOf, Hash, Equal, Alloc>::Clear() {
+	while (head != nullptr) {
+		Node *next = head->next;
+		deleteNode(head);
+		head = next;
+	}
+	tail = nullptr;
+	size = 0;
+	index.clear();
+}
+
+/**
+ * Visit every value from head to tail
+ */
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+template<class Visit>
+void LinkedList<Key, Value, KeyOf, Hash, Equal, Alloc>::ForEach(Visit visit) const {
+	for (const Node *node = head; node != nullptr; node = node->next) {
+		visit(node->value);
+	}
+}
+
+/**
+ * Choose how Find reorders the list after a hit. Move-to-front
+ * adapts fastest to a change in which values are popular, transpose
+ * is steadier under a fixed skew. An indexed list finds values without
+ * scanning, so it keeps its order.
+ */
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+void LinkedList<Key, Value, KeyOf, Hash, Equal, Alloc>::SetSearchOrder(
+		SearchOrder order) {
+	searchOrder = order;
+}
+
+// Total nodes Find has compared, to measure how well an order works
+template<class Key, class Value, class KeyOf, class Hash, class Equal, class Alloc>
+unsigned long long LinkedList<Key, Value, KeyOf, Hash, Equal, Alloc>::NodesVisited() const {
+	return nodesVisited;
+}
+
+} // namespace core
+
+#endif /* CORE_LINKEDLIST_HPP_ */
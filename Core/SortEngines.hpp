@@ -0,0 +1,674 @@
+/*
+ * Comparison sort engines shared by the programs, written once as
+ * templates over any random access sequence (a vector<T, Alloc>) and a
+ * strict weak ordering, so the ordering is inlined for each record type
+ */
+
+#ifndef CORE_SORTENGINES_HPP_
+#define CORE_SORTENGINES_HPP_
+
+#include <algorithm>
+#include <utility>
+
+namespace core {
+
+// Ranges this small are finished with insertion sort
+const int INSERTION_SORT_THRESHOLD = 16;
+
+// Ranges larger than this pick their pivot with Tukey's ninther
+const int NINTHER_THRESHOLD = 128;
+
+// Values examined per block by the branchless partition
+const int PARTITION_BLOCK_SIZE = 64;
+
+// Insertion sort on an already partitioned range gives up after this many moves
+const int PARTIAL_INSERTION_SORT_LIMIT = 8;
+
+/**
+ * Order values by a key pulled out with KeyOf and compared with Compare
+ */
+template<class KeyOf, class Compare>
+struct KeyLess {
+	KeyOf keyOf;
+	Compare compare;
+	KeyLess(KeyOf keyOf = KeyOf(), Compare compare = Compare()) :
+			keyOf(keyOf), compare(compare) {
+	}
+	template<class Value>
+	bool operator()(const Value &a, const Value &b) const {
+		return compare(keyOf(a), keyOf(b));
+	}
+};
+
+/**
+ * Exchange two values. The unqualified call lets a record type supply
+ * its own swap, which the Vector benchmark uses to count swaps.
+ */
+template<class Value>
+inline void swapValues(Value &a, Value &b) {
+	using std::swap;
+	swap(a, b);
+}
+
+/**
+ * To facilitate QuickSort
+ * Partition the sequence into two parts, low and high
+ *
+ * @param items Sequence to be partitioned
+ * @param begin Beginning index to partition
+ * @param end Ending index to partition
+ * @param less Ordering of the values
+ */
+template<class Sequence, class Compare>
+int partition(Sequence &items, int begin, int end, Compare less) {
+	int low = begin;
+	int high = end;
+
+	// Relative center of partition, copied since swaps can move that value
+	typename Sequence::value_type pivot = items.at(begin + (end - begin) / 2);
+
+	bool done = false;
+	while (!done) {
+		while (less(items.at(low), pivot)) {
+			++low;
+		}
+
+		while (less(pivot, items.at(high))) {
+			--high;
+		}
+
+		if (low >= high) {
+			done = true;
+		} else {
+			swapValues(items.at(low), items.at(high));
+
+			++low;
+			--high;
+		}
+	}
+
+	return high;
+}
+
+/**
+ * Perform a quick sort
+ * Average performance: O(n log(n))
+ * Worst case performance O(n^2))
+ *
+ * @param items Sequence to be sorted
+ * @param begin the beginning index to sort on
+ * @param end the ending index to sort on
+ * @param less Ordering of the values
+ */
+template<class Sequence, class Compare>
+void quickSort(Sequence &items, int begin, int end, Compare less) {
+	while (begin < end) {
+		int mid = partition(items, begin, end, less);
+
+		// recurse into the smaller partition and loop on the larger one,
+		// so inputs that defeat the middle pivot cannot overflow the stack
+		if (mid - begin < end - mid) {
+			quickSort(items, begin, mid, less);
+			begin = mid + 1;
+		} else {
+			quickSort(items, mid + 1, end, less);
+			end = mid;
+		}
+	}
+}
+
+/**
+ * Perform a selection sort
+ * Average performance: O(n^2))
+ * Worst case performance O(n^2))
+ *
+ * @param items Sequence to be sorted
+ * @param less Ordering of the values
+ */
+template<class Sequence, class Compare>
+void selectionSort(Sequence &items, Compare less) {
+	for (unsigned int i = 0; i < items.size(); ++i) {
+		unsigned int min = i;
+
+		for (unsigned int j = i + 1; j < items.size(); ++j) {
+			if (less(items.at(j), items.at(min))) {
+				min = j;
+			}
+		}
+
+		if (min != i) {
+			swapValues(items.at(i), items.at(min));
+		}
+	}
+}
+
+/**
+ * Perform an insertion sort over a small range
+ *
+ * @param begin the beginning index to sort on
+ * @param end the ending index to sort on
+ */
+template<class Sequence, class Compare>
+void insertionSort(Sequence &items, int begin, int end, Compare less) {
+	for (int i = begin + 1; i <= end; ++i) {
+		if (!less(items[i], items[i - 1])) {
+			continue;
+		}
+
+		// shift larger values right and drop the value into the gap
+		typename Sequence::value_type value = std::move(items[i]);
+		int j = i;
+		do {
+			items[j] = std::move(items[j - 1]);
+			--j;
+		} while (j > begin && less(value, items[j - 1]));
+		items[j] = std::move(value);
+	}
+}
+
+/**
+ * Restore the heap property below index root of a max-heap
+ * laid out over items[begin..begin + count - 1]
+ */
+template<class Sequence, class Compare>
+void siftDown(Sequence &items, int begin, int root, int count, Compare less) {
+	while (true) {
+		int child = 2 * root + 1;
+		if (child >= count) {
+			return;
+		}
+		if (child + 1 < count
+				&& less(items[begin + child], items[begin + child + 1])) {
+			++child;
+		}
+		if (!less(items[begin + root], items[begin + child])) {
+			return;
+		}
+		swapValues(items[begin + root], items[begin + child]);
+		root = child;
+	}
+}
+
+/**
+ * Perform a heap sort
+ * Worst case performance O(n log(n))
+ *
+ * @param begin the beginning index to sort on
+ * @param end the ending index to sort on
+ */
+template<class Sequence, class Compare>
+void heapSort(Sequence &items, int begin, int end, Compare less) {
+	int count = end - begin + 1;
+
+	for (int root = count / 2 - 1; root >= 0; --root) {
+		siftDown(items, begin, root, count, less);
+	}
+	for (int last = count - 1; last > 0; --last) {
+		swapValues(items[begin], items[begin + last]);
+		siftDown(items, begin, 0, last, less);
+	}
+}
+
+/**
+ * Order three values so the median ends up at index b
+ */
+template<class Sequence, class Compare>
+void sortThree(Sequence &items, int a, int b, int c, Compare less) {
+	if (less(items[b], items[a])) {
+		swapValues(items[a], items[b]);
+	}
+	if (less(items[c], items[b])) {
+		swapValues(items[b], items[c]);
+		if (less(items[b], items[a])) {
+			swapValues(items[a], items[b]);
+		}
+	}
+}
+
+/**
+ * To facilitate IntroSort
+ * Choose a median-of-three (or ninther) pivot, then partition the range
+ * around it. Scans stop on values equal to the pivot, so runs of
+ * duplicates are split evenly instead of degrading to O(n^2).
+ *
+ * @return index the pivot ended up at
+ */
+template<class Sequence, class Compare>
+int introPartition(Sequence &items, int begin, int end, Compare less) {
+	int mid = begin + (end - begin) / 2;
+
+	if (end - begin + 1 > NINTHER_THRESHOLD) {
+		int step = (end - begin + 1) / 8;
+		sortThree(items, begin, begin + step, begin + 2 * step, less);
+		sortThree(items, mid - step, mid, mid + step, less);
+		sortThree(items, end - 2 * step, end - step, end, less);
+		sortThree(items, begin + step, mid, end - step, less);
+	} else {
+		sortThree(items, begin, mid, end, less);
+	}
+
+	// park the pivot at the front while partitioning
+	swapValues(items[begin], items[mid]);
+	const typename Sequence::value_type &pivot = items[begin];
+
+	int low = begin;
+	int high = end + 1;
+	while (true) {
+		while (less(items[++low], pivot)) {
+			if (low == end) {
+				break;
+			}
+		}
+		while (less(pivot, items[--high])) {
+		}
+		if (low >= high) {
+			break;
+		}
+		swapValues(items[low], items[high]);
+	}
+
+	swapValues(items[begin], items[high]);
+	return high;
+}
+
+/**
+ * Quick sort loop of IntroSort. Recurses into the smaller side and
+ * loops on the larger one, so the stack stays O(log n) deep.
+ */
+template<class Sequence, class Compare>
+void introSortLoop(Sequence &items, int begin, int end, int depthLimit,
+		Compare less) {
+	while (end - begin + 1 > INSERTION_SORT_THRESHOLD) {
+		// too many bad pivots, fall back to a guaranteed O(n log(n))
+		if (depthLimit == 0) {
+			heapSort(items, begin, end, less);
+			return;
+		}
+		--depthLimit;
+
+		int mid = introPartition(items, begin, end, less);
+		if (mid - begin < end - mid) {
+			introSortLoop(items, begin, mid - 1, depthLimit, less);
+			begin = mid + 1;
+		} else {
+			introSortLoop(items, mid + 1, end, depthLimit, less);
+			end = mid - 1;
+		}
+	}
+
+	insertionSort(items, begin, end, less);
+}
+
+/**
+ * Perform an introspective sort: quick sort with median-of-three/ninther
+ * pivots, insertion sort for small ranges and heap sort once recursion
+ * passes 2 log(n) levels
+ * Average performance: O(n log(n))
+ * Worst case performance O(n log(n))
+ *
+ * @param items Sequence to be sorted
+ * @param less Ordering of the values
+ */
+template<class Sequence, class Compare>
+void introSort(Sequence &items, Compare less) {
+	int depthLimit = 0;
+	for (size_t n = items.size(); n > 1; n >>= 1) {
+		depthLimit += 2;
+	}
+
+	introSortLoop(items, 0, (int) items.size() - 1, depthLimit, less);
+}
+
+/**
+ * Insertion sort that gives up once it has moved too many values, used
+ * to finish ranges that look sorted without risking O(n^2)
+ *
+ * @param begin the beginning index to sort on
+ * @param end one past the ending index
+ * @return true if the range is now sorted
+ */
+template<class Sequence, class Compare>
+bool partialInsertionSort(Sequence &items, int begin, int end, Compare less) {
+	int limit = 0;
+
+	for (int i = begin + 1; i < end; ++i) {
+		if (!less(items[i], items[i - 1])) {
+			continue;
+		}
+
+		typename Sequence::value_type value = std::move(items[i]);
+		int j = i;
+		do {
+			items[j] = std::move(items[j - 1]);
+			--j;
+		} while (j > begin && less(value, items[j - 1]));
+		items[j] = std::move(value);
+
+		limit += i - j;
+		if (limit > PARTIAL_INSERTION_SORT_LIMIT) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Swap num pairs of misplaced values found by the block partition. When
+ * the counts differ the pairs are rotated as one cycle, which needs
+ * one move per value instead of the three of a swap.
+ */
+template<class Sequence>
+void swapOffsets(Sequence &items, int leftBase, int rightBase,
+		const unsigned char *offsetsLeft, const unsigned char *offsetsRight,
+		int num, bool useSwaps) {
+	if (useSwaps) {
+		for (int i = 0; i < num; ++i) {
+			swapValues(items[leftBase + offsetsLeft[i]],
+					items[rightBase - offsetsRight[i]]);
+		}
+	} else if (num > 0) {
+		int left = leftBase + offsetsLeft[0];
+		int right = rightBase - offsetsRight[0];
+		typename Sequence::value_type temp = std::move(items[left]);
+		items[left] = std::move(items[right]);
+		for (int i = 1; i < num; ++i) {
+			left = leftBase + offsetsLeft[i];
+			items[right] = std::move(items[left]);
+			right = rightBase - offsetsRight[i];
+			items[left] = std::move(items[right]);
+		}
+		items[right] = std::move(temp);
+	}
+}
+
+/**
+ * To facilitate PdqSort
+ * Partition around the pivot at begin with equal values going right.
+ * Values are compared a block at a time and only the offsets of
+ * misplaced values are recorded, by adding the comparison result to a
+ * counter rather than branching on it (BlockQuicksort).
+ *
+ * @param begin the beginning index, holding the pivot
+ * @param end one past the ending index
+ * @param alreadyPartitioned set when no value had to move
+ * @return index the pivot ended up at
+ */
+template<class Sequence, class Compare>
+int partitionRightBranchless(Sequence &items, int begin, int end,
+		bool &alreadyPartitioned, Compare less) {
+	typename Sequence::value_type pivot = std::move(items[begin]);
+	int first = begin;
+	int last = end;
+
+	// the median-of-three guarantees a value >= pivot exists
+	while (less(items[++first], pivot)) {
+	}
+
+	// only guard the scan if nothing was smaller than the pivot
+	if (first - 1 == begin) {
+		while (first < last && !less(items[--last], pivot)) {
+		}
+	} else {
+		while (!less(items[--last], pivot)) {
+		}
+	}
+
+	alreadyPartitioned = first >= last;
+	if (!alreadyPartitioned) {
+		swapValues(items[first], items[last]);
+		++first;
+
+		unsigned char offsetsLeft[PARTITION_BLOCK_SIZE];
+		unsigned char offsetsRight[PARTITION_BLOCK_SIZE];
+		int leftBase = first;
+		int rightBase = last;
+		int numLeft = 0, numRight = 0, startLeft = 0, startRight = 0;
+
+		while (first < last) {
+			// split what is left between the blocks that need refilling
+			int unknown = last - first;
+			int leftSplit = numLeft == 0 ? (numRight == 0 ? unknown / 2 : unknown) : 0;
+			int rightSplit = numRight == 0 ? unknown - leftSplit : 0;
+			if (leftSplit > PARTITION_BLOCK_SIZE) {
+				leftSplit = PARTITION_BLOCK_SIZE;
+			}
+			if (rightSplit > PARTITION_BLOCK_SIZE) {
+				rightSplit = PARTITION_BLOCK_SIZE;
+			}
+
+			// record values on the wrong side without branching on the result
+			for (int i = 0; i < leftSplit;) {
+				offsetsLeft[numLeft] = i++;
+				numLeft += !less(items[first], pivot);
+				++first;
+			}
+			for (int i = 0; i < rightSplit;) {
+				offsetsRight[numRight] = ++i;
+				numRight += less(items[--last], pivot);
+			}
+
+			int num = std::min(numLeft, numRight);
+			swapOffsets(items, leftBase, rightBase, offsetsLeft + startLeft,
+					offsetsRight + startRight, num, numLeft == numRight);
+			numLeft -= num;
+			numRight -= num;
+			startLeft += num;
+			startRight += num;
+
+			if (numLeft == 0) {
+				startLeft = 0;
+				leftBase = first;
+			}
+			if (numRight == 0) {
+				startRight = 0;
+				rightBase = last;
+			}
+		}
+
+		// one side still has misplaced values, swap them past the other
+		if (numLeft > 0) {
+			while (numLeft--) {
+				swapValues(items[leftBase + offsetsLeft[startLeft + numLeft]],
+						items[--last]);
+			}
+			first = last;
+		}
+		if (numRight > 0) {
+			while (numRight--) {
+				swapValues(items[rightBase - offsetsRight[startRight + numRight]],
+						items[first]);
+				++first;
+			}
+			last = first;
+		}
+	}
+
+	int pivotPos = first - 1;
+	items[begin] = std::move(items[pivotPos]);
+	items[pivotPos] = std::move(pivot);
+	return pivotPos;
+}
+
+/**
+ * To facilitate PdqSort
+ * Partition around the pivot at begin with equal values going left.
+ * Only used when the pivot equals the value just before the range, so
+ * every value on the left equals the pivot and is already in place.
+ *
+ * @return index the pivot ended up at
+ */
+template<class Sequence, class Compare>
+int partitionLeft(Sequence &items, int begin, int end, Compare less) {
+	typename Sequence::value_type pivot = std::move(items[begin]);
+	int first = begin;
+	int last = end;
+
+	while (less(pivot, items[--last])) {
+	}
+
+	if (last + 1 == end) {
+		while (first < last && !less(pivot, items[++first])) {
+		}
+	} else {
+		while (!less(pivot, items[++first])) {
+		}
+	}
+
+	while (first < last) {
+		swapValues(items[first], items[last]);
+		while (less(pivot, items[--last])) {
+		}
+		while (!less(pivot, items[++first])) {
+		}
+	}
+
+	items[begin] = std::move(items[last]);
+	items[last] = std::move(pivot);
+	return last;
+}
+
+/**
+ * Quick sort loop of PdqSort
+ *
+ * @param begin the beginning index to sort on
+ * @param end one past the ending index
+ * @param badAllowed unbalanced partitions left before falling back to heap sort
+ * @param leftmost false when items[begin - 1] is a previous pivot
+ */
+template<class Sequence, class Compare>
+void pdqSortLoop(Sequence &items, int begin, int end, int badAllowed,
+		bool leftmost, Compare less) {
+	while (true) {
+		int size = end - begin;
+
+		if (size <= INSERTION_SORT_THRESHOLD) {
+			insertionSort(items, begin, end - 1, less);
+			return;
+		}
+
+		// median of three or pseudomedian of nine, moved to begin
+		int half = size / 2;
+		if (size > NINTHER_THRESHOLD) {
+			sortThree(items, begin, begin + half, end - 1, less);
+			sortThree(items, begin + 1, begin + half - 1, end - 2, less);
+			sortThree(items, begin + 2, begin + half + 1, end - 3, less);
+			sortThree(items, begin + half - 1, begin + half, begin + half + 1,
+					less);
+			swapValues(items[begin], items[begin + half]);
+		} else {
+			sortThree(items, begin + half, begin, end - 1, less);
+		}
+
+		// pivot equal to the previous pivot: many duplicates, so group
+		// every value equal to it on the left and skip past them
+		if (!leftmost && !less(items[begin - 1], items[begin])) {
+			begin = partitionLeft(items, begin, end, less) + 1;
+			continue;
+		}
+
+		bool alreadyPartitioned;
+		int pivotPos = partitionRightBranchless(items, begin, end,
+				alreadyPartitioned, less);
+
+		int leftSize = pivotPos - begin;
+		int rightSize = end - (pivotPos + 1);
+		if (leftSize < size / 8 || rightSize < size / 8) {
+			// too many bad partitions, fall back to a guaranteed O(n log(n))
+			if (--badAllowed == 0) {
+				heapSort(items, begin, end - 1, less);
+				return;
+			}
+
+			// shuffle a few values to break up the pattern that caused it
+			if (leftSize >= INSERTION_SORT_THRESHOLD) {
+				swapValues(items[begin], items[begin + leftSize / 4]);
+				swapValues(items[pivotPos - 1], items[pivotPos - leftSize / 4]);
+				if (leftSize > NINTHER_THRESHOLD) {
+					swapValues(items[begin + 1], items[begin + leftSize / 4 + 1]);
+					swapValues(items[begin + 2], items[begin + leftSize / 4 + 2]);
+					swapValues(items[pivotPos - 2], items[pivotPos - leftSize / 4 - 1]);
+					swapValues(items[pivotPos - 3], items[pivotPos - leftSize / 4 - 2]);
+				}
+			}
+			if (rightSize >= INSERTION_SORT_THRESHOLD) {
+				swapValues(items[pivotPos + 1], items[pivotPos + 1 + rightSize / 4]);
+				swapValues(items[end - 1], items[end - rightSize / 4]);
+				if (rightSize > NINTHER_THRESHOLD) {
+					swapValues(items[pivotPos + 2], items[pivotPos + 2 + rightSize / 4]);
+					swapValues(items[pivotPos + 3], items[pivotPos + 3 + rightSize / 4]);
+					swapValues(items[end - 2], items[end - 1 - rightSize / 4]);
+					swapValues(items[end - 3], items[end - 2 - rightSize / 4]);
+				}
+			}
+		} else if (alreadyPartitioned
+				&& partialInsertionSort(items, begin, pivotPos, less)
+				&& partialInsertionSort(items, pivotPos + 1, end, less)) {
+			// a balanced partition that moved nothing was probably sorted
+			return;
+		}
+
+		// recurse on the left, loop on the right
+		pdqSortLoop(items, begin, pivotPos, badAllowed, leftmost, less);
+		begin = pivotPos + 1;
+		leftmost = false;
+	}
+}
+
+/**
+ * Perform a pattern-defeating quick sort (pdqsort) over a range.
+ * Sorted and reverse sorted input is detected in one linear pass,
+ * partitioning is branchless, and runs of equal values are split off
+ * with a three-way partition instead of being sorted again.
+ * Average performance: O(n log(n)), O(n) for sorted or reversed input
+ * Worst case performance O(n log(n))
+ *
+ * @param items Sequence to be sorted
+ * @param begin the beginning index to sort on
+ * @param end one past the ending index
+ * @param less Ordering of the values
+ */
+template<class Sequence, class Compare>
+void pdqSortRange(Sequence &items, int begin, int end, Compare less) {
+	int size = end - begin;
+	if (size < 2) {
+		return;
+	}
+
+	// already ascending, or strictly descending and only needs reversing
+	int i = begin + 1;
+	while (i < end && !less(items[i], items[i - 1])) {
+		++i;
+	}
+	if (i == end) {
+		return;
+	}
+	if (i == begin + 1) {
+		while (i < end && less(items[i], items[i - 1])) {
+			++i;
+		}
+		if (i == end) {
+			std::reverse(items.begin() + begin, items.begin() + end);
+			return;
+		}
+	}
+
+	int badAllowed = 0;
+	for (int n = size; n > 1; n >>= 1) {
+		++badAllowed;
+	}
+
+	pdqSortLoop(items, begin, end, badAllowed, true, less);
+}
+
+/**
+ * Perform a pattern-defeating quick sort on the whole sequence
+ */
+template<class Sequence, class Compare>
+void pdqSort(Sequence &items, Compare less) {
+	pdqSortRange(items, 0, (int) items.size(), less);
+}
+
+} // namespace core
+
+#endif /* CORE_SORTENGINES_HPP_ */
@@ -0,0 +1,65 @@
+/*
+ * Zipf-distributed popularity ranks, shared by the benchmarks that
+ * replay skewed lookups
+ */
+
+#ifndef CORE_ZIPFDISTRIBUTION_HPP_
+#define CORE_ZIPFDISTRIBUTION_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace core {
+
+/**
+ * Draws ranks 0 to ranks - 1 with Zipf's law: rank k comes up in
+ * proportion to 1 / (k + 1)^s, so rank 0 is the most popular. The
+ * cumulative weights are summed once, and each draw is one uniform
+ * number and a binary search over them.
+ */
+class ZipfDistribution {
+
+private:
+	std::vector<double> cumulative;
+	std::uniform_real_distribution<double> uniform;
+
+public:
+	ZipfDistribution(size_t ranks, double exponent);
+	template<class Random>
+	size_t operator()(Random &random);
+};
+
+/**
+ * Constructor
+ *
+ * @param ranks Number of ranks to draw from, at least 1
+ * @param exponent The exponent s, larger is more skewed
+ */
+inline ZipfDistribution::ZipfDistribution(size_t ranks, double exponent) :
+		cumulative(ranks) {
+	double total = 0.0;
+	for (size_t rank = 0; rank < cumulative.size(); ++rank) {
+		total += 1.0 / std::pow(rank + 1.0, exponent);
+		cumulative[rank] = total;
+	}
+	uniform = std::uniform_real_distribution<double>(0.0, total);
+}
+
+/**
+ * Draw a rank
+ *
+ * @param random Any standard random number engine
+ */
+template<class Random>
+size_t ZipfDistribution::operator()(Random &random) {
+	size_t rank = std::upper_bound(cumulative.begin(), cumulative.end(),
+			uniform(random)) - cumulative.begin();
+	return std::min(rank, cumulative.size() - 1);
+}
+
+} // namespace core
+
+#endif /* CORE_ZIPFDISTRIBUTION_HPP_ */
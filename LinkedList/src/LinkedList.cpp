@@ -4,52 +4,146 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
 #include <time.h>
+#include <unordered_map>
+#include <vector>
 
-#include "CSVparser.hpp"
+#include "Bid.hpp"
+#include "LinkedList.hpp"
+#include "ZipfDistribution.hpp"
 
 using namespace std;
 
+// Operations shared by the linked list variants
+class BidList {
+
+public:
+	virtual ~BidList() {
+	}
+	virtual void Append(Bid bid) = 0;
+	virtual void Prepend(Bid bid) = 0;
+	virtual void PrintList() = 0;
+	virtual void Remove(string bidId) = 0;
+	virtual Bid Search(string bidId) = 0;
+	virtual int Size() = 0;
+	virtual void Clear() = 0;
+};
+
+typedef core::LinkedList<string, Bid, BidIdOf> BidLinkedList;
+
+// The singly linked list of bids, with its index and search orders
+class LinkedList: public BidList, public BidLinkedList {
+
+public:
+	LinkedList(bool indexed = false);
+	void Append(Bid bid);
+	void Prepend(Bid bid);
+	void PrintList();
+	void Remove(string bidId);
+	Bid Search(string bidId);
+	int Size();
+	void Clear();
+};
+
 /**
- * Simple C function to convert a string to a double
- * after stripping out unwanted char
+ * Constructor
  *
- * credit: http://stackoverflow.com/a/24875936
+ * @param indexed keep a hash index of bid IDs, so Search and Remove
+ *                take O(1) and adding a bid whose ID is already in the
+ *                list replaces that bid in place
+ */
+LinkedList::LinkedList(bool indexed) :
+		BidLinkedList(indexed) {
+}
+
+// Append a new bid to the end of the list
+void LinkedList::Append(Bid bid) {
+	BidLinkedList::Append(bid);
+}
+
+// Prepend a new bid to the start of the list
+void LinkedList::Prepend(Bid bid) {
+	BidLinkedList::Prepend(bid);
+}
+
+// Print all bid objects to console
+void LinkedList::PrintList() {
+
+	ForEach(displayBid);
+}
+
+/**
+ * Remove a specified bid
  *
- * @param ch The character to strip out
+ * @param bidId The bid id to remove from the list
  */
-double strToDouble(string str, char ch) {
-	str.erase(remove(str.begin(), str.end(), ch), str.end());
-	return atof(str.c_str());
+void LinkedList::Remove(string bidId) {
+	BidLinkedList::Remove(bidId);
 }
 
-// A structure to hold bid information
-struct Bid {
-	string bidId; // unique identifier
-	string title;
-	string fund;
-	double amount;
-	Bid() {
-		amount = 0.0;
-	}
-};
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ */
+Bid LinkedList::Search(string bidId) {
+	return BidLinkedList::Search(bidId);
+}
+
+// Returns the current size (number of elements) in the list
+int LinkedList::Size() {
+	return BidLinkedList::Size();
+}
 
-class LinkedList {
+// Delete every node, walking the list once
+void LinkedList::Clear() {
+	BidLinkedList::Clear();
+}
+
+// Bids per unrolled node, so its search keys fill two cache lines
+const unsigned int UNROLLED_NODE_CAPACITY = 16;
+
+/**
+ * Pack the first 8 characters of a bid ID into an integer, so most
+ * non-matching bids are ruled out by one integer compare
+ */
+unsigned long long bidIdKey(const string &bidId) {
+	unsigned long long key = 0;
+	memcpy(&key, bidId.data(), min(bidId.size(), sizeof(key)));
+	return key;
+}
+
+/**
+ * Linked list that keeps several bids per node. Each node also keeps
+ * a packed key per bid next to each other, so a search reads 8 bytes
+ * per bid and chases one pointer per node instead of one per bid, and
+ * the pointer and allocation overhead is shared across the node.
+ */
+class UnrolledLinkedList: public BidList {
 
 private:
-	// Defines node in singly-linked list, consisting of bid object and next pointer
+	// Node holding the bids in slots [first, last) of its arrays
 	struct Node {
-		Bid bid;
+		unsigned long long keys[UNROLLED_NODE_CAPACITY];
+		Bid bids[UNROLLED_NODE_CAPACITY];
+		unsigned int first;
+		unsigned int last;
 		Node *next;
 
-		Node() {
-			next = nullptr;
-		}
-
-		// initialize a node with a bid
-		Node(Bid aBid) {
-			bid = aBid;
+		// an empty node filled from slot start
+		Node(unsigned int start) {
+			first = last = start;
 			next = nullptr;
 		}
 	};
@@ -59,136 +153,487 @@ private:
 	int size = 0;
 
 public:
-	LinkedList();
-	virtual ~LinkedList();
+	UnrolledLinkedList();
+	virtual ~UnrolledLinkedList();
+	// copies would share, and both delete, the same nodes
+	UnrolledLinkedList(const UnrolledLinkedList&) = delete;
+	UnrolledLinkedList &operator=(const UnrolledLinkedList&) = delete;
 	void Append(Bid bid);
 	void Prepend(Bid bid);
 	void PrintList();
 	void Remove(string bidId);
 	Bid Search(string bidId);
 	int Size();
+	void Clear();
 };
 
-LinkedList::LinkedList() {
-	// Initialize head and tail as null pointers until list is populated with nodes
+UnrolledLinkedList::UnrolledLinkedList() {
 	head = tail = nullptr;
 }
 
-LinkedList::~LinkedList() {
+UnrolledLinkedList::~UnrolledLinkedList() {
+	Clear();
 }
 
-// Append a new bid to the end of the list
-void LinkedList::Append(Bid bid) {
-	Node *newNode = new Node(bid);
-	// If first node, set as head node
-	if (head == nullptr) {
-		head = newNode;
+// Delete every node, walking the list once
+void UnrolledLinkedList::Clear() {
+	while (head != nullptr) {
+		Node *next = head->next;
+		delete head;
+		head = next;
+	}
+	tail = nullptr;
+	size = 0;
+}
 
-	} else {
-		//check to see if a tail node exists, and if so, assigns the next pointer of what was previously the tail to the new node
-		if (tail != nullptr) {
+// Append a new bid to the end of the list, opening a node when the tail is full
+void UnrolledLinkedList::Append(Bid bid) {
+	if (tail == nullptr || tail->last == UNROLLED_NODE_CAPACITY) {
+		Node *newNode = new Node(0);
+		if (tail == nullptr) {
+			head = newNode;
+		} else {
 			tail->next = newNode;
 		}
+		tail = newNode;
 	}
 
-	// new node is  now the tail
-	tail = newNode;
-
+	tail->keys[tail->last] = bidIdKey(bid.bidId);
+	tail->bids[tail->last++] = move(bid);
 	++size;
 }
 
-// Prepend a new bid to the start of the list
-void LinkedList::Prepend(Bid bid) {
-	Node *newNode = new Node(bid);
-
-	// if a head node exists, set new node next ptr to current head
-	if (head != nullptr) {
+// Prepend a new bid to the start of the list, filling the head node back to front
+void UnrolledLinkedList::Prepend(Bid bid) {
+	if (head == nullptr || head->first == 0) {
+		Node *newNode = new Node(UNROLLED_NODE_CAPACITY);
 		newNode->next = head;
+		head = newNode;
+		if (tail == nullptr) {
+			tail = newNode;
+		}
 	}
 
-	head = newNode;
-
+	head->keys[--head->first] = bidIdKey(bid.bidId);
+	head->bids[head->first] = move(bid);
 	++size;
 }
 
 // Print all bid objects to console
-void LinkedList::PrintList() {
-
-	// Forward declaration
-	void displayBid(Bid bid);
+void UnrolledLinkedList::PrintList() {
 
-	// Start at head node
-	Node *curNode = head;
+	for (Node *curNode = head; curNode != nullptr; curNode = curNode->next) {
+		for (unsigned int i = curNode->first; i < curNode->last; ++i) {
+			displayBid(curNode->bids[i]);
+		}
+	}
+}
 
-	// Iterate until next ptr is nullptr (ie through whole linked list)
-	while (curNode != nullptr) {
+/**
+ * Remove a specified bid. A node left empty is unlinked, and a node
+ * whose bids fit into its neighbour's free slots is merged into it
+ * so the list stays dense.
+ *
+ * @param bidId The bid id to remove from the list
+ */
+void UnrolledLinkedList::Remove(string bidId) {
+	unsigned long long key = bidIdKey(bidId);
+	Node *previous = nullptr;
+
+	for (Node *curNode = head; curNode != nullptr; curNode = curNode->next) {
+		for (unsigned int i = curNode->first; i < curNode->last; ++i) {
+			if (curNode->keys[i] != key
+					|| curNode->bids[i].bidId.compare(bidId) != 0) {
+				continue;
+			}
 
-		displayBid(curNode->bid);
+			// close the gap
+			move(curNode->keys + i + 1, curNode->keys + curNode->last,
+					curNode->keys + i);
+			move(curNode->bids + i + 1, curNode->bids + curNode->last,
+					curNode->bids + i);
+			curNode->bids[--curNode->last] = Bid();
+			--size;
 
-		// Continue iterating
-		curNode = curNode->next;
+			Node *next = curNode->next;
+			if (curNode->first == curNode->last) {
+				// unlink the empty node
+				if (previous == nullptr) {
+					head = next;
+				} else {
+					previous->next = next;
+				}
+				if (tail == curNode) {
+					tail = previous;
+				}
+				delete curNode;
+			} else if (next != nullptr
+					&& next->last - next->first
+							<= UNROLLED_NODE_CAPACITY - curNode->last) {
+				// pull the next node's bids in and drop it
+				for (unsigned int j = next->first; j < next->last; ++j) {
+					curNode->keys[curNode->last] = next->keys[j];
+					curNode->bids[curNode->last++] = move(next->bids[j]);
+				}
+				curNode->next = next->next;
+				if (tail == next) {
+					tail = curNode;
+				}
+				delete next;
+			}
+			return;
+		}
+		previous = curNode;
 	}
 }
 
 /**
- * Remove a specified bid
+ * Search for the specified bidId
  *
- * @param bidId The bid id to remove from the list
+ * @param bidId The bid id to search for
  */
-void LinkedList::Remove(string bidId) {
-	// Node to be deleted is head node
-	if (head != nullptr) {
-		if (head->bid.bidId.compare(bidId) == 0) {
-
-			// transfer pointers
-			Node *tempNode = head->next;
-			delete head;
-			head = tempNode;
+Bid UnrolledLinkedList::Search(string bidId) {
+	unsigned long long key = bidIdKey(bidId);
+
+	for (Node *curNode = head; curNode != nullptr; curNode = curNode->next) {
+		for (unsigned int i = curNode->first; i < curNode->last; ++i) {
+			if (curNode->keys[i] == key
+					&& curNode->bids[i].bidId.compare(bidId) == 0) {
+				return curNode->bids[i];
+			}
 		}
 	}
 
-	Node *curNode = head;
+	// Return empty object if sought bid not found
+	Bid emptyBid;
+	return emptyBid;
+}
 
-	// Iterate the whole linked list
-	while (curNode->next != nullptr) {
+// Returns the current size (number of elements) in the list
+int UnrolledLinkedList::Size() {
+	return size;
+}
 
-		// Sought bid is found in next ptr
-		if (curNode->next->bid.bidId.compare(bidId) == 0) {
+// Tallest skip list tower, enough for 4^16 bids at p = 1/4
+const int SKIP_LIST_MAX_LEVEL = 16;
 
-			// transfer pointers to skip node
-			Node *tempNode = curNode->next;
-			curNode->next = tempNode->next;
+// Bytes carved from the heap at a time by the skip list node pool
+const size_t SKIP_POOL_BLOCK_BYTES = 64 * 1024;
 
-			delete tempNode;
+/**
+ * Allocator for variable-sized skip list nodes. Memory is carved from
+ * large blocks and freed nodes are kept on one free list per tower
+ * height, so a node and its tower are one allocation next to its
+ * neighbours instead of separate news.
+ */
+class SkipNodePool {
 
-			--size;
-			return;
-		}
+private:
+	vector<char*> blocks;
+	char *cursor;
+	size_t remaining;
+	void *freeLists[SKIP_LIST_MAX_LEVEL + 1];
+
+public:
+	SkipNodePool();
+	virtual ~SkipNodePool();
+	// the pool owns its blocks, a copy would delete them again
+	SkipNodePool(const SkipNodePool&) = delete;
+	SkipNodePool &operator=(const SkipNodePool&) = delete;
+	void* Allocate(size_t bytes, int height);
+	void Free(void *memory, int height);
+	void Release();
+};
 
-		// Continue iterating
-		curNode = curNode->next;
+SkipNodePool::SkipNodePool() {
+	cursor = nullptr;
+	remaining = 0;
+	fill(freeLists, freeLists + SKIP_LIST_MAX_LEVEL + 1, nullptr);
+}
+
+SkipNodePool::~SkipNodePool() {
+	Release();
+}
+
+// Free every block at once, invalidating all nodes handed out
+void SkipNodePool::Release() {
+	for (char *block : blocks) {
+		delete[] block;
 	}
+	blocks.clear();
+	cursor = nullptr;
+	remaining = 0;
+	fill(freeLists, freeLists + SKIP_LIST_MAX_LEVEL + 1, nullptr);
 }
 
 /**
- * Search for the specified bidId
+ * Allocate memory for a node of the given tower height
  *
- * @param bidId The bid id to search for
+ * @param bytes Size of a node of that height, keeping the next
+ *              node aligned
  */
-Bid LinkedList::Search(string bidId) {
+void* SkipNodePool::Allocate(size_t bytes, int height) {
+	if (freeLists[height] != nullptr) {
+		void *memory = freeLists[height];
+		freeLists[height] = *static_cast<void**>(memory);
+		return memory;
+	}
 
-	Node *curNode = head;
+	if (remaining < bytes) {
+		cursor = new char[SKIP_POOL_BLOCK_BYTES];
+		remaining = SKIP_POOL_BLOCK_BYTES;
+		blocks.push_back(cursor);
+	}
+	void *memory = cursor;
+	cursor += bytes;
+	remaining -= bytes;
+	return memory;
+}
 
-	// Iterate the whole linked list
-	while (curNode != nullptr) {
+// Return a node's memory to the free list for its height
+void SkipNodePool::Free(void *memory, int height) {
+	*static_cast<void**>(memory) = freeLists[height];
+	freeLists[height] = memory;
+}
 
-		// Sought bid found
-		if (curNode->bid.bidId.compare(bidId) == 0) {
-			return curNode->bid;
+/**
+ * Linked list kept in bid ID order (compareBidIds) as a skip list.
+ * Every node carries a random tower of forward pointers, so Search,
+ * Insert and Remove skip ahead in expected O(log n) steps. Towers are
+ * short (p = 1/4) and the packed length and prefix of each bid ID
+ * (packBidId) sit next to them, so most steps compare integers in the
+ * node header without touching the bid.
+ * Adding a bid whose ID is already in the list replaces that bid.
+ */
+class SkipBidList: public BidList {
+
+private:
+	// Node header, followed in the same allocation by its tower and bid
+	struct Node {
+		unsigned long long key;
+		int height;
+		Node *next[1];
+
+		// offset of the bid, after the tower and aligned for it
+		static size_t bidOffset(int height) {
+			size_t end = offsetof(Node, next) + height * sizeof(Node*);
+			return (end + alignof(Bid) - 1) / alignof(Bid) * alignof(Bid);
+		}
+
+		// the bid stored after the height entries of next
+		Bid& bid() {
+			return *reinterpret_cast<Bid*>(reinterpret_cast<char*>(this)
+					+ bidOffset(height));
 		}
+	};
+
+	SkipNodePool pool;
+	Node *head; // sorts before every bid
+	int level; // levels in use
+	unsigned int seed;
+	int size = 0;
+
+	Node* newNode(Bid bid, int height);
+	void deleteNode(Node *node);
+	void destroyBids();
+	int randomHeight();
+	bool less(Node *node, unsigned long long key, const string &bidId);
+	Node* findPredecessors(const string &bidId, Node *preds[]);
+
+public:
+	SkipBidList();
+	virtual ~SkipBidList();
+	// nodes live in the pool and point at each other, so copies cannot share them
+	SkipBidList(const SkipBidList&) = delete;
+	SkipBidList &operator=(const SkipBidList&) = delete;
+	bool Insert(Bid bid);
+	void Append(Bid bid);
+	void Prepend(Bid bid);
+	void PrintList();
+	void Remove(string bidId);
+	Bid Search(string bidId);
+	void Range(string fromBidId, string toBidId,
+			function<void(const Bid&)> visit);
+	int Size();
+	void Clear();
+};
+
+SkipBidList::SkipBidList() {
+	head = newNode(Bid(), SKIP_LIST_MAX_LEVEL);
+	for (int i = 0; i < SKIP_LIST_MAX_LEVEL; ++i) {
+		head->next[i] = nullptr;
+	}
+	level = 1;
+	seed = 2463534242;
+}
+
+SkipBidList::~SkipBidList() {
+	// the pool frees the memory, only the bids need destroying
+	destroyBids();
+}
+
+// Run the destructor of every bid, head included, without freeing nodes
+void SkipBidList::destroyBids() {
+	for (Node *node = head; node != nullptr; node = node->next[0]) {
+		node->bid().~Bid();
+	}
+}
+
+// Drop every bid and hand all node memory back in one release
+void SkipBidList::Clear() {
+	destroyBids();
+	pool.Release();
+
+	head = newNode(Bid(), SKIP_LIST_MAX_LEVEL);
+	for (int i = 0; i < SKIP_LIST_MAX_LEVEL; ++i) {
+		head->next[i] = nullptr;
+	}
+	level = 1;
+	size = 0;
+}
+
+// Allocate a node from the pool with room for its tower and bid
+SkipBidList::Node* SkipBidList::newNode(Bid bid, int height) {
+	size_t bytes = Node::bidOffset(height) + sizeof(Bid);
+	Node *node = static_cast<Node*>(pool.Allocate(bytes, height));
+	node->key = packBidId(bid.bidId);
+	node->height = height;
+	new (&node->bid()) Bid(move(bid));
+	return node;
+}
+
+void SkipBidList::deleteNode(Node *node) {
+	node->bid().~Bid();
+	pool.Free(node, node->height);
+}
+
+/**
+ * Geometric tower height with p = 1/4, so a node has 1.33 forward
+ * pointers on average
+ */
+int SkipBidList::randomHeight() {
+	// xorshift32
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+
+	int height = 1;
+	unsigned int bits = seed;
+	while ((bits & 3) == 0 && height < SKIP_LIST_MAX_LEVEL) {
+		++height;
+		bits >>= 2;
+	}
+	return height;
+}
+
+// True if the node's bid ID sorts before bidId, whose packed key is key
+bool SkipBidList::less(Node *node, unsigned long long key,
+		const string &bidId) {
+	if (node->key != key) {
+		return node->key < key;
+	}
+	return compareBidIds(node->bid().bidId, bidId) < 0;
+}
+
+/**
+ * Find the last node before bidId on every level in use
+ *
+ * @param preds Set to the predecessor on each level
+ * @return the first node at or after bidId, or nullptr
+ */
+SkipBidList::Node* SkipBidList::findPredecessors(const string &bidId,
+		Node *preds[]) {
+	unsigned long long key = packBidId(bidId);
+	Node *node = head;
+	for (int i = level - 1; i >= 0; --i) {
+		while (node->next[i] != nullptr && less(node->next[i], key, bidId)) {
+			node = node->next[i];
+		}
+		preds[i] = node;
+	}
+	return node->next[0];
+}
+
+/**
+ * Insert a bid in bid ID order
+ *
+ * @return true if the bid was added, false if it replaced a bid with
+ *         the same ID
+ */
+bool SkipBidList::Insert(Bid bid) {
+	Node *preds[SKIP_LIST_MAX_LEVEL];
+	Node *found = findPredecessors(bid.bidId, preds);
+	if (found != nullptr && found->bid().bidId.compare(bid.bidId) == 0) {
+		found->bid() = bid;
+		return false;
+	}
+
+	int height = randomHeight();
+	for (; level < height; ++level) {
+		preds[level] = head;
+	}
+
+	Node *node = newNode(bid, height);
+	for (int i = 0; i < height; ++i) {
+		node->next[i] = preds[i]->next[i];
+		preds[i]->next[i] = node;
+	}
+
+	++size;
+	return true;
+}
+
+// The list keeps bid ID order, so appending inserts in place
+void SkipBidList::Append(Bid bid) {
+	Insert(bid);
+}
+
+// The list keeps bid ID order, so prepending inserts in place
+void SkipBidList::Prepend(Bid bid) {
+	Insert(bid);
+}
+
+// Print all bid objects to console in bid ID order
+void SkipBidList::PrintList() {
+
+	for (Node *node = head->next[0]; node != nullptr; node = node->next[0]) {
+		displayBid(node->bid());
+	}
+}
+
+/**
+ * Remove a specified bid
+ *
+ * @param bidId The bid id to remove from the list
+ */
+void SkipBidList::Remove(string bidId) {
+	Node *preds[SKIP_LIST_MAX_LEVEL];
+	Node *found = findPredecessors(bidId, preds);
+	if (found == nullptr || found->bid().bidId.compare(bidId) != 0) {
+		return;
+	}
 
-		// Continue iterating
-		curNode = curNode->next;
+	for (int i = 0; i < found->height; ++i) {
+		preds[i]->next[i] = found->next[i];
+	}
+	while (level > 1 && head->next[level - 1] == nullptr) {
+		--level;
+	}
+
+	deleteNode(found);
+	--size;
+}
+
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ */
+Bid SkipBidList::Search(string bidId) {
+	Node *preds[SKIP_LIST_MAX_LEVEL];
+	Node *found = findPredecessors(bidId, preds);
+	if (found != nullptr && found->bid().bidId.compare(bidId) == 0) {
+		return found->bid();
 	}
 
 	// Return empty object if sought bid not found
@@ -196,107 +641,496 @@ Bid LinkedList::Search(string bidId) {
 	return emptyBid;
 }
 
+/**
+ * Visit the bids with IDs from fromBidId to toBidId inclusive, in
+ * order, without copying them
+ */
+void SkipBidList::Range(string fromBidId, string toBidId,
+		function<void(const Bid&)> visit) {
+	Node *preds[SKIP_LIST_MAX_LEVEL];
+	for (Node *node = findPredecessors(fromBidId, preds);
+			node != nullptr && compareBidIds(node->bid().bidId, toBidId) <= 0;
+			node = node->next[0]) {
+		visit(node->bid());
+	}
+}
+
 // Returns the current size (number of elements) in the list
-int LinkedList::Size() {
+int SkipBidList::Size() {
 	return size;
 }
 
+// Links embedded in each entry of an IntrusiveBidList
+struct ListHook {
+	ListHook *previous;
+	ListHook *next;
+
+	ListHook() {
+		previous = next = this;
+	}
+};
+
+// A bid carrying its own list links, so it needs no separate node
+struct BidEntry: ListHook {
+	Bid bid;
+
+	BidEntry(Bid aBid) {
+		bid = aBid;
+	}
+};
+
+// Stable reference to a bid in an IntrusiveBidList, valid until it is removed
+typedef BidEntry *BidHandle;
+
+/**
+ * Circular doubly-linked list whose links live in the entries. Adding
+ * a bid returns a handle that stays valid while the bid is in a list,
+ * even when it is spliced into another one, so removing by handle and
+ * splicing whole lists are O(1) with no scan and no copying.
+ */
+class IntrusiveBidList {
+
+private:
+	ListHook sentinel; // before the first entry and after the last
+	int size = 0;
+
+	void linkBefore(ListHook *position, BidEntry *entry);
+
+public:
+	IntrusiveBidList();
+	virtual ~IntrusiveBidList();
+	// entries link back to this list's own sentinel, so it cannot be copied
+	IntrusiveBidList(const IntrusiveBidList&) = delete;
+	IntrusiveBidList &operator=(const IntrusiveBidList&) = delete;
+	BidHandle Append(Bid bid);
+	BidHandle Prepend(Bid bid);
+	void PrintList();
+	void Remove(BidHandle handle);
+	BidHandle Find(string bidId);
+	void Splice(BidHandle position, IntrusiveBidList &other);
+	void Concatenate(IntrusiveBidList &other);
+	int Size();
+	void Clear();
+};
+
+IntrusiveBidList::IntrusiveBidList() {
+}
+
+IntrusiveBidList::~IntrusiveBidList() {
+	Clear();
+}
+
+// Delete every entry, invalidating all handles into the list
+void IntrusiveBidList::Clear() {
+	ListHook *hook = sentinel.next;
+	while (hook != &sentinel) {
+		ListHook *next = hook->next;
+		delete static_cast<BidEntry*>(hook);
+		hook = next;
+	}
+	sentinel.next = sentinel.previous = &sentinel;
+	size = 0;
+}
+
+// Link an entry in just before position
+void IntrusiveBidList::linkBefore(ListHook *position, BidEntry *entry) {
+	entry->previous = position->previous;
+	entry->next = position;
+	position->previous->next = entry;
+	position->previous = entry;
+	++size;
+}
+
+// Append a new bid to the end of the list
+BidHandle IntrusiveBidList::Append(Bid bid) {
+	BidEntry *entry = new BidEntry(bid);
+	linkBefore(&sentinel, entry);
+	return entry;
+}
+
+// Prepend a new bid to the start of the list
+BidHandle IntrusiveBidList::Prepend(Bid bid) {
+	BidEntry *entry = new BidEntry(bid);
+	linkBefore(sentinel.next, entry);
+	return entry;
+}
+
+// Print all bid objects to console
+void IntrusiveBidList::PrintList() {
+
+	for (ListHook *hook = sentinel.next; hook != &sentinel; hook = hook->next) {
+		displayBid(static_cast<BidEntry*>(hook)->bid);
+	}
+}
+
 /**
- * Display the bid information
+ * Remove a bid by its handle, in O(1)
  *
- * @param bid struct containing the bid info
+ * @param handle A handle to a bid in this list
  */
-void displayBid(Bid bid) {
-	cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
-			<< bid.fund << endl;
-	return;
+void IntrusiveBidList::Remove(BidHandle handle) {
+	handle->previous->next = handle->next;
+	handle->next->previous = handle->previous;
+	delete handle;
+	--size;
 }
 
 /**
- * Prompt user for bid information
+ * Search for the specified bidId
  *
- * @return Bid struct containing the bid info
+ * @param bidId The bid id to search for
+ * @return a handle to the first bid with that ID, or nullptr
  */
-Bid getBid() {
-	Bid bid;
+BidHandle IntrusiveBidList::Find(string bidId) {
+	for (ListHook *hook = sentinel.next; hook != &sentinel; hook = hook->next) {
+		BidEntry *entry = static_cast<BidEntry*>(hook);
+		if (entry->bid.bidId.compare(bidId) == 0) {
+			return entry;
+		}
+	}
+	return nullptr;
+}
 
-	cout << "Enter Id: ";
-	cin.ignore();
-	getline(cin, bid.bidId);
+/**
+ * Move every bid of another list into this one in O(1). Handles to
+ * the moved bids stay valid and now belong to this list.
+ *
+ * @param position A handle in this list to insert before, or nullptr
+ *                 to insert at the end
+ * @param other The list to take the bids from, left empty
+ */
+void IntrusiveBidList::Splice(BidHandle position, IntrusiveBidList &other) {
+	if (&other == this || other.size == 0) {
+		return;
+	}
 
-	cout << "Enter title: ";
-	getline(cin, bid.title);
+	ListHook *before = position != nullptr ? position : &sentinel;
+	ListHook *first = other.sentinel.next;
+	ListHook *last = other.sentinel.previous;
 
-	cout << "Enter fund: ";
-	cin >> bid.fund;
+	first->previous = before->previous;
+	before->previous->next = first;
+	last->next = before;
+	before->previous = last;
+	size += other.size;
 
-	cout << "Enter amount: ";
-	cin.ignore();
-	string strAmount;
-	getline(cin, strAmount);
-	bid.amount = strToDouble(strAmount, '$');
+	other.sentinel.next = other.sentinel.previous = &other.sentinel;
+	other.size = 0;
+}
+
+// Move every bid of another list onto the end of this one
+void IntrusiveBidList::Concatenate(IntrusiveBidList &other) {
+	Splice(nullptr, other);
+}
 
-	return bid;
+// Returns the current size (number of elements) in the list
+int IntrusiveBidList::Size() {
+	return size;
 }
 
 /**
- * Load a CSV file containing bids into a LinkedList
+ * Lock-free queue that many threads append bids to while one thread
+ * drains them, after Dmitry Vyukov's MPSC queue. A producer swaps its
+ * node in as the newest with a single atomic exchange and then links
+ * the previous newest node to it, so producers never wait on a lock
+ * or on each other. The consumer walks next links from the oldest
+ * node, which is always a drained placeholder. A bid whose producer
+ * is between those two steps, and every bid behind it, becomes
+ * visible as soon as the producer links it in.
+ */
+class MpscBidQueue {
+
+private:
+	// Bid carrying its own link, one allocation per queued bid
+	struct Node {
+		atomic<Node*> next;
+		Bid bid;
+
+		Node() :
+				next(nullptr) {
+		}
+
+		Node(Bid aBid) :
+				next(nullptr), bid(move(aBid)) {
+		}
+	};
+
+	atomic<Node*> newest; // producers' end
+	Node *oldest; // consumer's end, already drained
+
+public:
+	MpscBidQueue();
+	virtual ~MpscBidQueue();
+	// producers hold pointers into the queue's nodes, copying makes no sense
+	MpscBidQueue(const MpscBidQueue&) = delete;
+	MpscBidQueue &operator=(const MpscBidQueue&) = delete;
+	void Append(Bid bid);
+	unsigned int Drain(vector<Bid> &batch, unsigned int maxBatch);
+};
+
+MpscBidQueue::MpscBidQueue() {
+	oldest = new Node();
+	newest.store(oldest);
+}
+
+MpscBidQueue::~MpscBidQueue() {
+	while (oldest != nullptr) {
+		Node *next = oldest->next.load();
+		delete oldest;
+		oldest = next;
+	}
+}
+
+/**
+ * Append a bid, safe to call from any number of threads at once
+ */
+void MpscBidQueue::Append(Bid bid) {
+	Node *node = new Node(move(bid));
+	Node *previous = newest.exchange(node, memory_order_acq_rel);
+	previous->next.store(node, memory_order_release);
+}
+
+/**
+ * Move up to maxBatch bids, oldest first, onto the end of batch. Only
+ * one thread may drain at a time.
  *
- * @return a LinkedList containing all the bids read
+ * @return the number of bids moved, 0 when none are visible yet
  */
-void loadBids(string csvPath, LinkedList *list) {
-	cout << "Loading CSV file " << csvPath << endl;
+unsigned int MpscBidQueue::Drain(vector<Bid> &batch, unsigned int maxBatch) {
+	unsigned int count = 0;
+	while (count < maxBatch) {
+		Node *next = oldest->next.load(memory_order_acquire);
+		if (next == nullptr) {
+			break;
+		}
 
-	// initialize the CSV Parser
-	csv::Parser file = csv::Parser(csvPath);
+		// next becomes the drained placeholder
+		batch.push_back(move(next->bid));
+		delete oldest;
+		oldest = next;
+		++count;
+	}
+	return count;
+}
 
-	try {
-		// Read rows of a CSV file
-		for (unsigned int i = 0; i < file.rowCount(); i++) {
+/**
+ * Load a CSV file containing bids into a linked list
+ *
+ * @param list the list to append the bids read to
+ */
+void loadBids(string csvPath, BidList *list) {
+	for (const Bid &bid : loadBids(csvPath)) {
+		// add this bid to the end
+		list->Append(bid);
+	}
+}
+
+/**
+ * Load a CSV file containing bids into one intrusive list per fund
+ *
+ * @param lists the lists to append the bids read to, by fund
+ */
+void loadBidsByFund(string csvPath, map<string, IntrusiveBidList> &lists) {
+	for (const Bid &bid : loadBids(csvPath)) {
+		// add this bid to the end of its fund's list
+		lists[bid.fund].Append(bid);
+	}
+}
 
-			// initialize a bid using data from current row (i)
+// Searches run for each search order by the Zipf benchmark
+const unsigned int ZIPF_BENCHMARK_SEARCHES = 20000;
+
+// Zipf exponent, the k-th most popular bid is searched for in
+// proportion to 1 / k^s
+const double ZIPF_EXPONENT = 1.0;
+
+/**
+ * Compare the search orders on skewed lookups: bid IDs are searched
+ * for with Zipf-distributed popularity, the popular ones scattered
+ * through the file, and each order reports the average number of
+ * nodes a search visited
+ */
+void zipfBenchmark(string csvPath) {
+	// collect the bid IDs in file order
+	vector<string> bidIds;
+	for (const Bid &bid : readBids(csvPath)) {
+		bidIds.push_back(bid.bidId);
+	}
+	if (bidIds.empty()) {
+		return;
+	}
+
+	// popularity ranks over a shuffled copy of the IDs
+	mt19937 random(42);
+	vector<string> byPopularity = bidIds;
+	shuffle(byPopularity.begin(), byPopularity.end(), random);
+
+	vector<string> searches(ZIPF_BENCHMARK_SEARCHES);
+	core::ZipfDistribution popularity(byPopularity.size(), ZIPF_EXPONENT);
+	for (string &bidId : searches) {
+		bidId = byPopularity[popularity(random)];
+	}
+
+	const char *names[] = { "fixed", "move-to-front", "transpose" };
+	core::SearchOrder orders[] = { core::SEARCH_FIXED,
+			core::SEARCH_MOVE_TO_FRONT, core::SEARCH_TRANSPOSE };
+	for (int i = 0; i < 3; ++i) {
+		LinkedList list;
+		for (const string &bidId : bidIds) {
 			Bid bid;
-			bid.bidId = file[i][1];
-			bid.title = file[i][0];
-			bid.fund = file[i][8];
-			bid.amount = strToDouble(file[i][4], '$');
+			bid.bidId = bidId;
+			list.Append(bid);
+		}
+		list.SetSearchOrder(orders[i]);
 
-			// add this bid to the end
-			list->Append(bid);
+		auto start = chrono::steady_clock::now();
+		for (const string &bidId : searches) {
+			list.Search(bidId);
 		}
+		double seconds = chrono::duration<double>(
+				chrono::steady_clock::now() - start).count();
 
-	} catch (csv::Error &e) {
-		std::cerr << e.what() << std::endl;
+		cout << names[i] << ": " << (double) list.NodesVisited() / searches.size()
+				<< " nodes visited per search, " << seconds << " seconds" << endl;
 	}
 }
 
-string getBidId() {
+// Bids appended in each run of the ingest benchmark
+const unsigned int INGEST_BENCHMARK_BIDS = 1 << 19;
+
+// Bids the consumer takes from the queue at a time
+const unsigned int INGEST_DRAIN_BATCH = 256;
+
+// Threads reading the CSV file into the queue for Ingest Bids
+const unsigned int INGEST_PRODUCERS = 4;
+
+/**
+ * Time producers appending bids from 1 to 16 threads while this thread
+ * drains them, once through the lock-free queue and once through a
+ * std::list behind a mutex that the consumer splices out in batches
+ */
+void ingestBenchmark() {
+	for (unsigned int producers = 1; producers <= 16; producers *= 2) {
+		unsigned int perProducer = INGEST_BENCHMARK_BIDS / producers;
+		unsigned int total = perProducer * producers;
+		double rates[2];
+
+		for (int mode = 0; mode < 2; ++mode) {
+			MpscBidQueue queue;
+			mutex lock;
+			list<Bid> locked;
+			list<Bid> lockedBatch;
+			vector<Bid> batch;
+			vector<thread> threads;
+
+			auto start = chrono::steady_clock::now();
+			for (unsigned int p = 0; p < producers; ++p) {
+				threads.push_back(thread([&, p]() {
+					for (unsigned int i = 0; i < perProducer; ++i) {
+						Bid bid;
+						bid.bidId = to_string(p * perProducer + i);
+						bid.title = "Ingested bid";
+						if (mode == 0) {
+							queue.Append(bid);
+						} else {
+							lock_guard<mutex> guard(lock);
+							locked.push_back(bid);
+						}
+					}
+				}));
+			}
 
-	string bidKey;
-	cout << "Enter a bid ID" << endl;
-	cin.ignore();
-	getline(cin, bidKey);
+			unsigned int received = 0;
+			while (received < total) {
+				unsigned int drained;
+				if (mode == 0) {
+					batch.clear();
+					drained = queue.Drain(batch, INGEST_DRAIN_BATCH);
+				} else {
+					lockedBatch.clear();
+					lock_guard<mutex> guard(lock);
+					lockedBatch.splice(lockedBatch.end(), locked);
+					drained = lockedBatch.size();
+				}
+				received += drained;
+				if (drained == 0) {
+					this_thread::yield();
+				}
+			}
+
+			for (thread &producer : threads) {
+				producer.join();
+			}
+			double seconds = chrono::duration<double>(
+					chrono::steady_clock::now() - start).count();
+			rates[mode] = total / seconds;
+		}
 
-	return bidKey;
+		cout << producers << " producers: lock-free " << rates[0]
+				<< " bids/s, mutex " << rates[1] << " bids/s" << endl;
+	}
 }
 
-void displayTime(clock_t ticks) {
-	ticks = clock() - ticks; // current clock ticks minus starting clock ticks
-	cout << "time: " << ticks << " ticks" << endl;
-	cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+/**
+ * Load a CSV file into a list through the lock-free queue. Producer
+ * threads each append a share of the bids to the queue while this
+ * thread drains them into the list, so the list itself is only ever
+ * touched by one thread. Bids from different producers arrive
+ * interleaved rather than in file order.
+ *
+ * @param list the list to append the bids read to
+ * @param producers Number of threads appending to the queue
+ * @return the number of bids ingested
+ */
+unsigned int ingestBids(string csvPath, BidList *list, unsigned int producers) {
+	vector<Bid> bids = loadBids(csvPath);
+	MpscBidQueue queue;
+
+	vector<thread> threads;
+	for (unsigned int p = 0; p < producers; ++p) {
+		threads.push_back(thread([&bids, &queue, p, producers]() {
+			for (size_t i = p; i < bids.size(); i += producers) {
+				queue.Append(bids[i]);
+			}
+		}));
+	}
+
+	vector<Bid> batch;
+	unsigned int received = 0;
+	while (received < bids.size()) {
+		batch.clear();
+		unsigned int drained = queue.Drain(batch, INGEST_DRAIN_BATCH);
+		for (const Bid &bid : batch) {
+			list->Append(bid);
+		}
+		received += drained;
+		if (drained == 0) {
+			this_thread::yield();
+		}
+	}
+
+	for (thread &producer : threads) {
+		producer.join();
+	}
+	return received;
 }
 
 /**
  * Main
  *
  * @param arg[1] path to CSV file to load from (optional)
+ * @param arg[2] "unrolled" to keep several bids per node, "indexed" to
+ *               index bids by ID, "skiplist" to keep bids in bid ID
+ *               order, or "move-to-front" or "transpose" to reorder
+ *               the list as bids are found (optional)
  */
 int main(int argc, char *argv[]) {
 
 	// process command line arguments
-	string csvPath, bidKey;
+	string csvPath, bidKey, lastBidKey;
 	switch (argc) {
 	case 2:
+	case 3:
 		csvPath = argv[1];
 		break;
 	default:
@@ -305,13 +1139,38 @@ int main(int argc, char *argv[]) {
 
 	clock_t ticks;
 
-	LinkedList bidList;
+	BidList *list;
+	if (argc == 3 && string(argv[2]) == "unrolled") {
+		cout << "Using unrolled linked list, " << UNROLLED_NODE_CAPACITY
+				<< " bids per node" << endl;
+		list = new UnrolledLinkedList();
+	} else if (argc == 3 && string(argv[2]) == "skiplist") {
+		cout << "Using skip list ordered by bid ID" << endl;
+		list = new SkipBidList();
+	} else if (argc == 3 && (string(argv[2]) == "move-to-front"
+			|| string(argv[2]) == "transpose")) {
+		cout << "Using self-organizing linked list, " << argv[2] << endl;
+		LinkedList *selfOrganizing = new LinkedList();
+		selfOrganizing->SetSearchOrder(
+				string(argv[2]) == "transpose" ?
+						core::SEARCH_TRANSPOSE : core::SEARCH_MOVE_TO_FRONT);
+		list = selfOrganizing;
+	} else if (argc == 3 && string(argv[2]) == "indexed") {
+		cout << "Using linked list indexed by bid ID" << endl;
+		list = new LinkedList(true);
+	} else {
+		list = new LinkedList();
+	}
+	BidList &bidList = *list;
 
 	Bid bid;
 
+	map<string, IntrusiveBidList> fundLists;
+	IntrusiveBidList merged;
+
 	// Load bid objects from CSV file
 	ticks = clock();
-	loadBids(csvPath, &bidList);
+	loadBids(csvPath, list);
 	cout << bidList.Size() << " bids read" << endl;
 	ticks = clock() - ticks; // current clock ticks minus starting clock ticks
 	displayTime(ticks);
@@ -324,6 +1183,12 @@ int main(int argc, char *argv[]) {
 		cout << "  3. Enter a Bid (Prepend)" << endl;
 		cout << "  4. Find Bid" << endl;
 		cout << "  5. Remove Bid" << endl;
+		cout << "  7. Merge Bids by Fund" << endl;
+		cout << "  8. Ingest Benchmark (Lock-Free Queue)" << endl;
+		cout << "  10. Display Bid ID Range (Skip List)" << endl;
+		cout << "  11. Self-Organizing Search Benchmark (Zipf)" << endl;
+		cout << "  12. Reload Benchmark (Memory)" << endl;
+		cout << "  13. Ingest Bids from Threads (Lock-Free Queue)" << endl;
 		cout << "  9. Exit" << endl;
 		cout << "Enter choice: ";
 
@@ -386,6 +1251,74 @@ int main(int argc, char *argv[]) {
 
 			break;
 
+		case 7:
+			// Build one list per fund, then splice them all into one
+			loadBidsByFund(csvPath, fundLists);
+			for (auto &fundList : fundLists) {
+				cout << (fundList.first.empty() ? "(no fund)" : fundList.first)
+						<< ": " << fundList.second.Size() << " bids" << endl;
+			}
+
+			ticks = clock();
+			for (auto &fundList : fundLists) {
+				merged.Concatenate(fundList.second);
+			}
+			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+
+			cout << merged.Size() << " bids merged from " << fundLists.size()
+					<< " funds" << endl;
+			displayTime(ticks);
+
+			break;
+
+		case 8:
+			ingestBenchmark();
+
+			break;
+
+		case 10:
+			if (dynamic_cast<SkipBidList*>(list) == nullptr) {
+				cout << "Start with the skiplist option to query ranges." << endl;
+				break;
+			}
+
+			// Prompt user for the first and last bid ID
+			bidKey = getBidId();
+			cout << "Enter the last bid ID" << endl;
+			getline(cin, lastBidKey);
+
+			ticks = clock();
+			dynamic_cast<SkipBidList*>(list)->Range(bidKey, lastBidKey,
+					[](const Bid &rangeBid) {
+						displayBid(rangeBid);
+					});
+			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+			displayTime(ticks);
+
+			break;
+
+		case 11:
+			zipfBenchmark(csvPath);
+
+			break;
+
+		case 12:
+			reloadBenchmark(csvPath, *list, &BidList::Append);
+
+			break;
+
+		case 13:
+			// Replace the list with the bids appended by producer threads
+			ticks = clock();
+			bidList.Clear();
+			cout << ingestBids(csvPath, list, INGEST_PRODUCERS)
+					<< " bids ingested from " << INGEST_PRODUCERS << " threads, "
+					<< bidList.Size() << " in the list" << endl;
+			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+			displayTime(ticks);
+
+			break;
+
 		case 9:
 			break;
 
@@ -396,6 +1329,8 @@ int main(int argc, char *argv[]) {
 		}
 	}
 
+	delete list;
+
 	cout << "Good bye." << endl;
 
 	return 0;
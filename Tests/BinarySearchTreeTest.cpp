@@ -0,0 +1,95 @@
+/*
+ * Checks the core BinarySearchTree stays ordered and balanced when bids
+ * arrive sorted by ID, as they do in the eBid CSV files
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "Bid.hpp"
+#include "BinarySearchTree.hpp"
+
+using namespace std;
+
+typedef core::BinarySearchTree<string, Bid, BidIdOf> BinarySearchTree;
+
+// Bids inserted in ascending ID order
+const unsigned int SORTED_BIDS = 100000;
+
+int failures = 0;
+
+/**
+ * Report a failed check
+ */
+void check(bool passed, const string &what) {
+	if (!passed) {
+		cerr << "FAIL: " << what << endl;
+		++failures;
+	}
+}
+
+/**
+ * Zero padded bid ID, so string order matches numeric order
+ */
+string bidIdOf(unsigned int number) {
+	char bidId[16];
+	snprintf(bidId, sizeof(bidId), "%08u", number);
+	return bidId;
+}
+
+int main() {
+	BinarySearchTree tree;
+	for (unsigned int i = 0; i < SORTED_BIDS; ++i) {
+		Bid bid;
+		bid.bidId = bidIdOf(i);
+		tree.Insert(bid);
+	}
+	check(tree.Size() == SORTED_BIDS, "size after sorted inserts");
+
+	for (unsigned int i = 0; i < SORTED_BIDS; ++i) {
+		string bidId = bidIdOf(i);
+		unsigned int rank = tree.Rank(bidId);
+		if (rank != i || tree.Select(rank).bidId != bidId) {
+			check(false, "Select(Rank(" + bidId + ")) after sorted inserts");
+			break;
+		}
+	}
+
+	// drop every other bid, so removes rebalance too
+	for (unsigned int i = 0; i < SORTED_BIDS; i += 2) {
+		tree.Remove(bidIdOf(i));
+	}
+	check(tree.Size() == SORTED_BIDS / 2, "size after removes");
+	check(!tree.Remove(bidIdOf(0)), "removing a missing bid");
+
+	for (unsigned int i = 1; i < SORTED_BIDS; i += 2) {
+		string bidId = bidIdOf(i);
+		unsigned int rank = tree.Rank(bidId);
+		if (rank != i / 2 || tree.Select(rank).bidId != bidId) {
+			check(false, "Select(Rank(" + bidId + ")) after removes");
+			break;
+		}
+	}
+	check(tree.Find(bidIdOf(0)) == nullptr, "removed bid not found");
+
+	string previous;
+	bool ordered = true;
+	tree.InOrder([&previous, &ordered](const Bid &bid) {
+		ordered = ordered && previous < bid.bidId;
+		previous = bid.bidId;
+	});
+	check(ordered, "in order traversal ascending");
+
+	// unpadded IDs rank numerically when ordered by compareBidIds
+	core::BinarySearchTree<string, Bid, BidIdOf, BidIdLess> byBidId;
+	for (unsigned int i = 1; i <= 1000; ++i) {
+		Bid bid;
+		bid.bidId = to_string(i);
+		byBidId.Insert(bid);
+	}
+	check(byBidId.Rank("100") == 99, "Rank orders bid IDs numerically");
+	check(byBidId.Select(9).bidId == "10", "Select orders bid IDs numerically");
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+/*
+ * Checks ConcurrentBidMap while several threads insert, remove and
+ * search at once. Each thread owns its own bid IDs, so the final
+ * contents are known whatever order the threads run in.
+ */
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Bid.hpp"
+#include "ConcurrentBidMap.hpp"
+
+using namespace std;
+
+const unsigned int TEST_THREADS = 4;
+
+// Bid IDs 1 to TEST_BIDS, so they span several lengths
+const unsigned int TEST_BIDS = 20000;
+
+int failures = 0;
+
+/**
+ * Report a failed check
+ */
+void check(bool passed, const string &what) {
+	if (!passed) {
+		cerr << "FAIL: " << what << endl;
+		++failures;
+	}
+}
+
+/**
+ * Bid whose ID is the given number
+ */
+Bid bidOf(unsigned int number) {
+	Bid bid;
+	bid.bidId = to_string(number);
+	bid.title = "Bid " + bid.bidId;
+	return bid;
+}
+
+/**
+ * Run body(thread) on TEST_THREADS threads and wait for all of them
+ */
+template<class Body>
+void onThreads(Body body) {
+	vector<thread> threads;
+	for (unsigned int t = 0; t < TEST_THREADS; ++t) {
+		threads.push_back(thread(body, t));
+	}
+	for (thread &worker : threads) {
+		worker.join();
+	}
+}
+
+/**
+ * True if the bids are exactly the given numbers, in numeric order
+ */
+bool numbered(const vector<Bid> &bids, unsigned int first, unsigned int step) {
+	for (unsigned int i = 0; i < bids.size(); ++i) {
+		if (bids[i].bidId != to_string(first + i * step)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main() {
+	ConcurrentBidMap map;
+
+	// thread t inserts the IDs equal to t modulo the thread count
+	onThreads([&map](unsigned int t) {
+		for (unsigned int number = t + 1; number <= TEST_BIDS;
+				number += TEST_THREADS) {
+			map.Insert(bidOf(number));
+		}
+	});
+	check(map.Size() == (int) TEST_BIDS, "size after concurrent inserts");
+	check(!map.Insert(bidOf(1)), "inserting a present bid");
+
+	vector<Bid> all = map.Range("1", to_string(TEST_BIDS));
+	check(all.size() == TEST_BIDS && numbered(all, 1, 1),
+			"range is in numeric order");
+
+	// half the threads remove odd IDs while the others search for even
+	// IDs, which must stay visible throughout
+	vector<unsigned int> misses(TEST_THREADS, 0);
+	onThreads([&map, &misses](unsigned int t) {
+		unsigned int half = TEST_THREADS / 2;
+		for (unsigned int number = 1 + 2 * (t % half); number <= TEST_BIDS;
+				number += 2 * half) {
+			if (t < half) {
+				map.Remove(to_string(number));
+			} else if (map.Search(to_string(number + 1)).bidId.empty()) {
+				++misses[t];
+			}
+		}
+	});
+	unsigned int missed = 0;
+	for (unsigned int count : misses) {
+		missed += count;
+	}
+	check(missed == 0, "untouched bids are found during removes");
+	check(map.Size() == (int) TEST_BIDS / 2, "size after concurrent removes");
+	check(map.Search("1").bidId.empty(), "removed bid not found");
+	check(!map.Remove("1"), "removing a missing bid");
+
+	vector<Bid> even = map.Range("2", to_string(TEST_BIDS));
+	check(even.size() == TEST_BIDS / 2 && numbered(even, 2, 2),
+			"range after removes");
+	check(map.Range("9", "11").size() == 1, "range bounds compare as numbers");
+
+	return failures == 0 ? 0 : 1;
+}
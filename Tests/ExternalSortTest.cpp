@@ -0,0 +1,108 @@
+/*
+ * Checks the external sort on a file with more runs than one merge
+ * can take, so runs are merged in more than one pass
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Bid.hpp"
+#include "BidSorting.hpp"
+
+using namespace std;
+
+// Rows in the generated CSV file
+const unsigned int TEST_ROWS = 5000;
+
+// Memory per run, a few dozen rows, so there are well over 64 runs
+const size_t RUN_BYTES = 4096;
+
+const char *const INPUT_PATH = "ExternalSortTest.csv";
+const char *const OUTPUT_PATH = "ExternalSortTest.sorted.csv";
+
+int failures = 0;
+
+/**
+ * Report a failed check
+ */
+void check(bool passed, const string &what) {
+	if (!passed) {
+		cerr << "FAIL: " << what << endl;
+		++failures;
+	}
+}
+
+/**
+ * Write a CSV file in the eBid layout. Row i has bid ID 10000 + i and
+ * one of a few titles, so equal titles are common and their input
+ * order can be checked from the IDs.
+ */
+void writeInput() {
+	ofstream out(INPUT_PATH);
+	out << "ArticleTitle,ArticleID,Department,CloseDate,WinningBid,"
+			<< "InventoryID,VehicleID,ReceiptNumber,Fund" << endl;
+	for (unsigned int i = 0; i < TEST_ROWS; ++i) {
+		out << "\"Lot " << (i * 37) % 97 << ", used\"," << 10000 + i
+				<< ",Parks,11/1/16,$" << i % 50 << ".25,,,,"
+				<< (i % 3 == 0 ? "Enterprise" : "General Fund") << endl;
+	}
+}
+
+int main() {
+	writeInput();
+
+	check(externalSort(INPUT_PATH, OUTPUT_PATH, RUN_BYTES, false),
+			"external sort succeeds");
+
+	ifstream sorted(OUTPUT_PATH);
+	string header, line;
+	getline(sorted, header);
+	check(header.compare(0, 12, "ArticleTitle") == 0, "header comes first");
+
+	vector<string> fields;
+	string previousTitle;
+	long previousId = 0;
+	unsigned int rows = 0;
+	bool ordered = true;
+	bool stable = true;
+	while (getline(sorted, line)) {
+		splitCsvLine(line, fields);
+		long bidId = atol(fields[1].c_str());
+		if (rows > 0 && fields[0] < previousTitle) {
+			ordered = false;
+		}
+		if (rows > 0 && fields[0] == previousTitle && bidId < previousId) {
+			stable = false;
+		}
+		previousTitle = fields[0];
+		previousId = bidId;
+		++rows;
+	}
+	sorted.close();
+	check(rows == TEST_ROWS, "every row is written once");
+	check(ordered, "rows are in title order");
+	check(stable, "equal titles keep their input order");
+
+	// the sorted file reads back like the input
+	vector<Bid> bids = readBids(OUTPUT_PATH);
+	unsigned int enterprise = 0;
+	for (const Bid &bid : bids) {
+		if (bid.fund == "Enterprise") {
+			++enterprise;
+		}
+	}
+	check(bids.size() == TEST_ROWS, "sorted file loads");
+	check(enterprise == (TEST_ROWS + 2) / 3, "funds survive the sort");
+
+	check(!externalSort("missing.csv", OUTPUT_PATH, RUN_BYTES, false),
+			"a missing input fails");
+
+	remove(INPUT_PATH);
+	remove(OUTPUT_PATH);
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+/*
+ * Checks readBids takes each field from the right column of both sample
+ * CSV layouts, so lookups by fund find the bids they should
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Bid.hpp"
+
+using namespace std;
+
+// The two sample files, which place the Fund column differently
+const char *SAMPLE_FILES[] = { "eBid_Monthly_Sales.csv",
+		"eBid_Monthly_Sales_Dec_2016.csv" };
+
+int failures = 0;
+
+/**
+ * Report a failed check
+ */
+void check(bool passed, const string &what) {
+	if (!passed) {
+		cerr << "FAIL: " << what << endl;
+		++failures;
+	}
+}
+
+int main() {
+	for (const char *csvPath : SAMPLE_FILES) {
+		vector<Bid> bids = readBids(csvPath);
+		check(!bids.empty(), string(csvPath) + " loads bids");
+
+		unsigned int generalFund = 0;
+		unsigned int feeAsFund = 0;
+		for (const Bid &bid : bids) {
+			if (bid.fund == "General Fund") {
+				++generalFund;
+			}
+			if (!bid.fund.empty() && bid.fund[0] == '$') {
+				++feeAsFund;
+			}
+		}
+		check(generalFund > 0, string(csvPath) + " has General Fund bids");
+		check(feeAsFund == 0, string(csvPath) + " reads no amounts as funds");
+	}
+
+	vector<string> header;
+	header.push_back("Auction Title");
+	header.push_back("Department ");
+	header.push_back("Fund");
+	check(csvColumn(header, "Department") == 1, "trailing spaces are trimmed");
+	check(csvColumn(header, "Fund") == 2, "Fund column is found by name");
+	check(csvColumn(header, "Receipt Number") == -1, "missing column is -1");
+
+	return failures == 0 ? 0 : 1;
+}
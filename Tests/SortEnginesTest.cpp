@@ -0,0 +1,160 @@
+/*
+ * Checks every bid sort engine, the parallel merge sort at several
+ * thread counts, sorting by specification and top-K against
+ * std::stable_sort on the same generated bids
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Bid.hpp"
+#include "BidSorting.hpp"
+
+using namespace std;
+
+// Bids sorted by each engine, small enough for selection sort
+const unsigned int TEST_BIDS = 3000;
+
+// Few distinct titles and funds, so equal keys are common
+const char *const TITLES[] = { "Chair", "Desk", "Lamp", "Printer", "Sofa",
+		"Table" };
+const char *const FUNDS[] = { "Enterprise", "General Fund" };
+
+int failures = 0;
+
+/**
+ * Report a failed check
+ */
+void check(bool passed, const string &what) {
+	if (!passed) {
+		cerr << "FAIL: " << what << endl;
+		++failures;
+	}
+}
+
+/**
+ * Bids with unique IDs of mixed lengths and repeated titles, the same
+ * for every run
+ */
+vector<Bid> testBids() {
+	mt19937 random(2016);
+	vector<Bid> bids(TEST_BIDS);
+	for (unsigned int i = 0; i < bids.size(); ++i) {
+		bids[i].bidId = to_string(i * 7919 % 100003);
+		bids[i].title = string(TITLES[random() % 6]) + " " + to_string(random() % 8);
+		bids[i].fund = FUNDS[random() % 2];
+		bids[i].amount = (random() % 10000) / 100.0;
+	}
+	return bids;
+}
+
+/**
+ * True if the bids are the same, in the same order
+ */
+bool sameBids(const vector<Bid> &a, const vector<Bid> &b) {
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (unsigned int i = 0; i < a.size(); ++i) {
+		if (a[i].bidId != b[i].bidId) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * True if the bids are ordered by field and hold the same bids as
+ * expected, whose order on that field is taken as the reference
+ */
+bool sortedLike(const vector<Bid> &sorted, const vector<Bid> &expected,
+		BidField field) {
+	if (sorted.size() != expected.size()) {
+		return false;
+	}
+	for (unsigned int i = 0; i < sorted.size(); ++i) {
+		if (compareField(sorted[i], expected[i], field) != 0) {
+			return false;
+		}
+	}
+
+	// equal keys may come out in any order, so compare the bids by ID
+	vector<Bid> a = sorted;
+	vector<Bid> b = expected;
+	auto byBidId = [](const Bid &x, const Bid &y) {
+		return compareBidIds(x.bidId, y.bidId) < 0;
+	};
+	sort(a.begin(), a.end(), byBidId);
+	sort(b.begin(), b.end(), byBidId);
+	return sameBids(a, b);
+}
+
+/**
+ * The bids stable sorted on one field
+ */
+vector<Bid> stableSorted(vector<Bid> bids, BidField field) {
+	stable_sort(bids.begin(), bids.end(), [field](const Bid &a, const Bid &b) {
+		return compareField(a, b, field) < 0;
+	});
+	return bids;
+}
+
+int main() {
+	vector<Bid> bids = testBids();
+
+	for (const SortEngine &engine : sortEngines()) {
+		vector<Bid> sorted = bids;
+		engine.sort(sorted);
+		check(sortedLike(sorted, stableSorted(bids, engine.field), engine.field),
+				engine.name + " sorts the bids");
+	}
+
+	// more threads than slices worth splitting, and odd run counts
+	vector<Bid> byTitle = stableSorted(bids, FIELD_TITLE);
+	for (unsigned int threads = 1; threads <= 9; ++threads) {
+		vector<Bid> sorted = bids;
+		parallelMergeSort(sorted, threads);
+		check(sortedLike(sorted, byTitle, FIELD_TITLE),
+				"parallel merge sort with " + to_string(threads) + " threads");
+	}
+	vector<Bid> few(bids.begin(), bids.begin() + 3);
+	parallelMergeSort(few, 8);
+	check(sortedLike(few, stableSorted(vector<Bid>(bids.begin(),
+			bids.begin() + 3), FIELD_TITLE), FIELD_TITLE),
+			"parallel merge sort with more threads than bids");
+
+	// sorting by specification is stable
+	vector<SortKey> keys;
+	check(parseSortSpec("fund, amount DESC", keys), "parse sort specification");
+	vector<Bid> bySpec = bids;
+	sortBySpec(bySpec, keys);
+	vector<Bid> expected = bids;
+	stable_sort(expected.begin(), expected.end(),
+			[](const Bid &a, const Bid &b) {
+				int order = compareField(a, b, FIELD_FUND);
+				if (order != 0) {
+					return order < 0;
+				}
+				return compareField(b, a, FIELD_AMOUNT) < 0;
+			});
+	check(sameBids(bySpec, expected), "sort by specification");
+	check(!parseSortSpec("fund sideways", keys), "reject a bad direction");
+
+	// top-K keeps ties in their original order, as a stable sort does
+	SortKey cheapest = { FIELD_AMOUNT, false };
+	for (unsigned int k : { 0u, 10u, 1000u, TEST_BIDS }) {
+		vector<unsigned int> top = topK(bids, k, cheapest);
+		vector<Bid> topBids;
+		for (unsigned int position : top) {
+			topBids.push_back(bids[position]);
+		}
+		vector<Bid> byAmount = stableSorted(bids, FIELD_AMOUNT);
+		byAmount.resize(k);
+		check(sameBids(topBids, byAmount), "top " + to_string(k) + " bids");
+	}
+
+	return failures == 0 ? 0 : 1;
+}
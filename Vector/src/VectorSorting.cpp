@@ -4,225 +4,387 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <time.h>
 
-#include "CSVparser.hpp"
+#include "Bid.hpp"
+#include "BidSorting.hpp"
+#include "FrozenBidIndex.hpp"
 
 using namespace std;
 
 /**
- * Simple C function to convert a string to a double
- * after stripping out unwanted char
- *
- * credit: http://stackoverflow.com/a/24875936
- *
- * @param ch The character to strip out
+ * Ordered secondary index over one column of a loaded set of bids.
+ * Only positions into the bid vector are stored, sorted by the column,
+ * so a query is a scan over the index instead of a full re-sort.
  */
-double strToDouble(string str, char ch) {
-	str.erase(remove(str.begin(), str.end(), ch), str.end());
-	return atof(str.c_str());
+class SecondaryIndex {
+
+private:
+	BidField field;
+	vector<unsigned int> positions;
+	bool built;
+
+public:
+	SecondaryIndex(BidField field);
+	void Build(const vector<Bid> &bids);
+	void Invalidate();
+	bool IsBuilt();
+	unsigned int Size();
+	unsigned int At(unsigned int rank);
+	void EqualRange(const vector<Bid> &bids, string key, unsigned int &first,
+			unsigned int &last);
+};
+
+SecondaryIndex::SecondaryIndex(BidField field) {
+	this->field = field;
+	built = false;
 }
 
-// A structure to hold bid information
-struct Bid {
-	string bidId; // unique identifier
-	string title;
-	string fund;
-	double amount;
-	Bid() {
-		amount = 0.0;
+/**
+ * Build the index for the current contents of the vector
+ *
+ * @param bids The bids being indexed
+ */
+void SecondaryIndex::Build(const vector<Bid> &bids) {
+	positions.resize(bids.size());
+	for (unsigned int i = 0; i < bids.size(); ++i) {
+		positions[i] = i;
 	}
-};
+
+	// stable so that bids with equal keys stay in load order
+	BidField column = field;
+	if (field == FIELD_TITLE) {
+		positions = titleOrder(bids);
+	} else {
+		stable_sort(positions.begin(), positions.end(),
+				[&bids, column](unsigned int a, unsigned int b) {
+					return compareField(bids[a], bids[b], column) < 0;
+				});
+	}
+
+	built = true;
+}
+
+/**
+ * Mark the index stale, positions are no longer valid once the
+ * vector is reloaded, sorted or appended to
+ */
+void SecondaryIndex::Invalidate() {
+	positions.clear();
+	built = false;
+}
+
+bool SecondaryIndex::IsBuilt() {
+	return built;
+}
+
+unsigned int SecondaryIndex::Size() {
+	return positions.size();
+}
 
 /**
- * Display the bid information
+ * Position in the bid vector of the entry at the given rank
  *
- * @param bid struct containing the bid info
+ * @param rank 0 is the smallest key
  */
-void displayBid(Bid bid) {
-	cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
-			<< bid.fund << endl;
-	return;
+unsigned int SecondaryIndex::At(unsigned int rank) {
+	return positions[rank];
 }
 
 /**
- * Prompt user for bid information
+ * Find the ranks of all entries whose key equals the given value
  *
- * @return Bid struct containing the bid info
+ * @param bids The indexed bids
+ * @param key Value to look for
+ * @param first Set to the rank of the first match
+ * @param last Set to one past the rank of the last match
  */
+void SecondaryIndex::EqualRange(const vector<Bid> &bids, string key,
+		unsigned int &first, unsigned int &last) {
+	Bid probe;
+	setField(probe, field, key);
+
+	BidField column = field;
+	first = lower_bound(positions.begin(), positions.end(), probe,
+			[&bids, column](unsigned int pos, const Bid &value) {
+				return compareField(bids[pos], value, column) < 0;
+			}) - positions.begin();
+	last = upper_bound(positions.begin() + first, positions.end(), probe,
+			[&bids, column](const Bid &value, unsigned int pos) {
+				return compareField(value, bids[pos], column) < 0;
+			}) - positions.begin();
+}
 
-Bid getBid() {
-	Bid bid;
+// The secondary indexes kept alongside the loaded bids
+struct BidIndexes {
+	SecondaryIndex title;
+	SecondaryIndex fund;
+	SecondaryIndex amount;
 
-	cout << "Enter Id: ";
-	cin.ignore();
-	getline(cin, bid.bidId);
+	BidIndexes() :
+			title(FIELD_TITLE), fund(FIELD_FUND), amount(FIELD_AMOUNT) {
+	}
 
-	cout << "Enter title: ";
-	getline(cin, bid.title);
+	void Invalidate() {
+		title.Invalidate();
+		fund.Invalidate();
+		amount.Invalidate();
+	}
+};
 
-	cout << "Enter fund: ";
-	cin >> bid.fund;
+// Ranges at most this long are finished with a binary search
+const unsigned int INTERPOLATION_CUTOFF = 8;
 
-	cout << "Enter amount: ";
-	cin.ignore();
-	string strAmount;
-	getline(cin, strAmount);
-	bid.amount = strToDouble(strAmount, '$');
+// Interpolation probes before giving up on a skewed ID distribution
+const unsigned int INTERPOLATION_MAX_PROBES = 32;
 
-	return bid;
+/**
+ * Binary search for every bid with an ID in bids[begin, end), which
+ * must be sorted by bid ID
+ *
+ * @return the half-open range of matching positions, empty if none
+ */
+pair<unsigned int, unsigned int> binarySearchBidId(const vector<Bid> &bids,
+		const string &bidId, unsigned int begin, unsigned int end) {
+	auto first = lower_bound(bids.begin() + begin, bids.begin() + end, bidId,
+			[](const Bid &bid, const string &key) {
+				return compareBidIds(bid.bidId, key) < 0;
+			});
+	auto last = upper_bound(first, bids.begin() + end, bidId,
+			[](const string &key, const Bid &bid) {
+				return compareBidIds(key, bid.bidId) < 0;
+			});
+	return make_pair((unsigned int) (first - bids.begin()),
+			(unsigned int) (last - bids.begin()));
 }
 
 /**
- * Load a CSV file containing bids into a container
+ * Search for every bid with an ID in a vector sorted by bid ID. Plain
+ * numeric IDs are found by interpolating between the IDs at the ends
+ * of the candidate range, which takes O(log log n) probes when IDs
+ * are spread evenly. Other IDs, skewed ranges and short ranges fall
+ * back to binary search.
  *
- * @param csvPath the path to the CSV file to load
- * @return a container holding all the bids read
+ * @param bids Bids sorted by bid ID
+ * @param bidId The bid ID to find
+ * @return the half-open range of matching positions, empty if none
  */
-vector<Bid> loadBids(string csvPath) {
-	cout << "Loading CSV file " << csvPath << endl;
-
-	vector<Bid> bids;
-
-	// initialize the CSV Parser
-	csv::Parser file = csv::Parser(csvPath);
+pair<unsigned int, unsigned int> interpolationSearchBidId(
+		const vector<Bid> &bids, const string &bidId) {
+	unsigned int low = 0;
+	unsigned int high = bids.size(); // matches lie in [low, high)
+	unsigned long long key, lowValue, highValue, value;
+
+	if (numericBidId(bidId, key)) {
+		for (unsigned int probes = 0;
+				high - low > INTERPOLATION_CUTOFF && probes < INTERPOLATION_MAX_PROBES;
+				++probes) {
+			if (!numericBidId(bids[low].bidId, lowValue)
+					|| !numericBidId(bids[high - 1].bidId, highValue)
+					|| lowValue == highValue) {
+				break;
+			}
+			if (key < lowValue || key > highValue) {
+				return make_pair(low, low);
+			}
 
-	try {
-		// loop to read rows of a CSV file
-		for (unsigned int i = 0; i < file.rowCount(); i++) {
+			unsigned int probe = low + (unsigned int) ((double) (key - lowValue)
+					/ (highValue - lowValue) * (high - 1 - low));
+			if (!numericBidId(bids[probe].bidId, value) || value == key) {
+				break;
+			}
+			if (value < key) {
+				low = probe + 1;
+			} else {
+				high = probe;
+			}
+		}
+	}
 
-			// Create a data structure and add to the collection of bids
-			Bid bid;
-			bid.bidId = file[i][1];
-			bid.title = file[i][0];
-			bid.fund = file[i][8];
-			bid.amount = strToDouble(file[i][4], '$');
+	return binarySearchBidId(bids, bidId, low, high);
+}
 
-			// push this bid to the end
-			bids.push_back(bid);
-		}
+/**
+ * Prompt the user for a line of text
+ *
+ * @param prompt Text to display before reading
+ * @return the line entered
+ */
+string getString(string prompt) {
 
-	} catch (csv::Error &e) {
-		std::cerr << e.what() << std::endl;
-	}
+	string value;
+	cout << prompt << endl;
+	cin.ignore();
+	getline(cin, value);
 
-	return bids;
+	return value;
 }
 
 /**
- * To facilitate QuickSort
- * Partition the vector of bids into two parts, low and high
+ * Answer a query from the secondary indexes, building the index
+ * that is needed on first use
  *
- * @param bids Address of the vector<Bid> instance to be partitioned
- * @param begin Beginning index to partition
- * @param end Ending index to partition
+ * @param bids The loaded bids
+ * @param indexes Indexes over the loaded bids
  */
-int partition(vector<Bid> &bids, int begin, int end) {
-	int low = begin;
-	int high = end;
+void queryIndexes(vector<Bid> &bids, BidIndexes &indexes) {
+	int query = 0;
+	unsigned int count = 0;
+	unsigned int first, last;
+	string key;
+	clock_t ticks;
+
+	cout << "  1. Top Winning Bids" << endl;
+	cout << "  2. Bids by Fund" << endl;
+	cout << "  3. Bids by Title" << endl;
+	cout << "Enter query: ";
+	if (!(cin >> query)) {
+		cin.clear();
+		cin.ignore();
+		query = 0;
+	}
 
-	// Relative center of partition
-	int pivot = begin + (end - begin) / 2;
+	switch (query) {
 
-	bool done = false;
-	while (!done) {
-		while (bids.at(low).title.compare(bids.at(pivot).title) < 0) {
-			++low;
+	case 1:
+		cout << "Enter number of bids: ";
+		if (!(cin >> count)) {
+			cin.clear();
+			cin.ignore();
+			count = 0;
+		}
+
+		ticks = clock();
+		if (!indexes.amount.IsBuilt()) {
+			indexes.amount.Build(bids);
 		}
 
-		while (bids.at(pivot).title.compare(bids.at(high).title) < 0) {
-			--high;
+		// highest amounts are at the end of the index
+		for (unsigned int i = 0; i < count && i < indexes.amount.Size(); ++i) {
+			displayBid(bids[indexes.amount.At(indexes.amount.Size() - 1 - i)]);
 		}
+		ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+		displayTime(ticks);
+
+		break;
+
+	case 2:
+	case 3: {
+		key = getString(query == 2 ? "Enter a fund" : "Enter a title");
 
-		if (low >= high) {
-			done = true;
-		} else {
-			swap(bids.at(low), bids.at(high)); // @suppress("Invalid arguments")
+		ticks = clock();
+		SecondaryIndex &index = (query == 2 ? indexes.fund : indexes.title);
+		if (!index.IsBuilt()) {
+			index.Build(bids);
+		}
 
-			++low;
-			--high;
+		index.EqualRange(bids, key, first, last);
+		for (unsigned int i = first; i < last; ++i) {
+			displayBid(bids[index.At(i)]);
 		}
+		cout << last - first << " bids found" << endl;
+		ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+		displayTime(ticks);
+
+		break;
 	}
 
-	return high;
+	default:
+		cout << "Not a valid query." << endl;
 
+		break;
+	}
 }
 
 /**
- * Perform a quick sort on bid title
- * Average performance: O(n log(n))
- * Worst case performance O(n^2))
+ * Prompt the user to pick a sort algorithm
  *
- * @param bids address of the vector<Bid> instance to be sorted
- * @param begin the beginning index to sort on
- * @param end the ending index to sort on
+ * @return the chosen engine, or nullptr for an invalid choice
  */
-void quickSort(vector<Bid> &bids, int begin, int end) {
-	int mid = 0;
+const SortEngine* chooseSortEngine(const vector<SortEngine> &engines) {
+	unsigned int choice = 0;
 
-	if (begin >= end) {
-		return;
+	for (unsigned int i = 0; i < engines.size(); ++i) {
+		cout << "  " << i + 1 << ". " << engines[i].name << endl;
+	}
+	cout << "Enter algorithm: ";
+	if (!(cin >> choice)) {
+		cin.clear();
+		cin.ignore();
+		choice = 0;
 	}
 
-	mid = partition(bids, begin, end);
-
-	// Recursive calls to each partition
-	quickSort(bids, begin, mid);
-	quickSort(bids, mid + 1, end);
+	if (choice < 1 || choice > engines.size()) {
+		cout << "Not a valid algorithm." << endl;
+		return nullptr;
+	}
+	return &engines[choice - 1];
 }
 
 /**
- * Perform a selection sort on bid title
- * Average performance: O(n^2))
- * Worst case performance O(n^2))
+ * Run every sort engine on its own copy of the bids and report the
+ * time each took next to quick sort's. Times are wall clock, since
+ * clock() adds up the CPU time of every thread of the parallel sort.
+ * Selection sort is left out for large inputs since it would dominate
+ * the run.
  *
- * @param bid address of the vector<Bid>
- *            instance to be sorted
+ * @param bids The bids to sort, left unchanged
+ * @param engines The engines to compare
  */
-void selectionSort(vector<Bid> &bids) {
-
-	unsigned int min;
-
-	for (unsigned int i = 0; i < bids.size(); ++i) {
-		min = i;
-
-		for (unsigned int j = i + 1; j < bids.size(); ++j) {
-			if (bids.at(j).title.compare(bids.at(min).title) < 0) {
-				min = j;
-			}
+void compareSortEngines(const vector<Bid> &bids,
+		const vector<SortEngine> &engines) {
+	double quickSeconds = 0.0;
+
+	for (const SortEngine &engine : engines) {
+		if (engine.sort == selectionSort && bids.size() > SELECTION_SORT_LIMIT) {
+			cout << engine.name << ": skipped for " << bids.size() << " bids"
+					<< endl;
+			continue;
+		}
 
+		vector<Bid> copy = bids;
+		auto start = chrono::steady_clock::now();
+		engine.sort(copy);
+		double seconds = chrono::duration<double>(
+				chrono::steady_clock::now() - start).count();
+		if (engine.sort == quickSortAll) {
+			quickSeconds = seconds;
 		}
 
-		if (min != i) {
-			swap(bids.at(i), bids.at(min)); // @suppress("Invalid arguments")
+		cout << engine.name << ": " << seconds << " seconds";
+		if (quickSeconds > 0.0 && seconds > 0.0) {
+			cout << " (" << quickSeconds / seconds << "x quick sort)";
 		}
+		cout << endl;
 	}
 }
 
-string getBidId() {
-
-	string bidKey;
-	cout << "Enter a bid ID" << endl;
-	cin.ignore();
-	getline(cin, bidKey);
-
-	return bidKey;
-}
-
-void displayTime(clock_t ticks) {
-	ticks = clock() - ticks; // current clock ticks minus starting clock ticks
-	cout << "time: " << ticks << " ticks" << endl;
-	cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
-}
-
 /**
  * Main
  *
  * @param arg[1] path to CSV file to load from (optional)
+ *
+ * or, to sort a file too large to load:
+ *   --external-sort input.csv output [memory MB] [csv|binary]
  */
 int main(int argc, char *argv[]) {
 
+	// non-interactive external sort
+	if (argc >= 4 && string(argv[1]) == "--external-sort") {
+		size_t memoryMegabytes = argc >= 5 ? atoi(argv[4]) : 64;
+		bool binaryOutput = argc >= 6 && string(argv[5]) == "binary";
+
+		clock_t ticks = clock();
+		bool sorted = externalSort(argv[2], argv[3],
+				max((size_t) 1, memoryMegabytes) * 1024 * 1024, binaryOutput);
+		ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+		displayTime(ticks);
+
+		return sorted ? 0 : 1;
+	}
+
 	// process command line arguments
 	string csvPath, bidKey;
 	switch (argc) {
@@ -236,12 +398,32 @@ int main(int argc, char *argv[]) {
 	// Define a vector to hold all the bids
 	vector<Bid> bids;
 
+	// Secondary indexes over the loaded bids, built on first query
+	BidIndexes indexes;
+
+	// Read-only bidId index, used by Find Bid once built
+	FrozenBidIndex frozen;
+
 	clock_t ticks;
 
 	Bid bid;
 
 	bool bidFound;
 
+	vector<SortEngine> engines = sortEngines();
+	const SortEngine *engine;
+
+	string sortSpec;
+	vector<SortKey> sortKeys;
+
+	unsigned int topCount;
+	vector<unsigned int> topPositions;
+
+	// column the bids are currently in ascending order of, if sorted
+	bool sorted = false;
+	BidField sortedBy = FIELD_TITLE;
+	pair<unsigned int, unsigned int> matches;
+
 	ticks = clock();
 
 	// Define a vector to hold all the bids
@@ -259,6 +441,12 @@ int main(int argc, char *argv[]) {
 		cout << "  4. Quick Sort All Bids" << endl;
 		cout << "  5. Find Bid" << endl;
 		cout << "  6. Enter a Bid" << endl;
+		cout << "  7. Query Secondary Indexes" << endl;
+		cout << "  8. Freeze Bid Index" << endl;
+		cout << "  10. Sort All Bids (Choose Algorithm)" << endl;
+		cout << "  11. Compare Sort Algorithms" << endl;
+		cout << "  12. Sort by Specification" << endl;
+		cout << "  13. Top K Bids" << endl;
 		cout << "  9. Exit" << endl;
 		cout << "Enter choice: ";
 
@@ -276,6 +464,9 @@ int main(int argc, char *argv[]) {
 		case 1:
 			ticks = clock();
 			bids = loadBids(csvPath); // Load the bids
+			indexes.Invalidate();
+			frozen.Clear();
+			sorted = false;
 			cout << bids.size() << " bids read" << endl;
 			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
 			displayTime(ticks);
@@ -294,6 +485,9 @@ int main(int argc, char *argv[]) {
 		case 3:
 			ticks = clock();
 			selectionSort(bids); // sort the bids
+			indexes.Invalidate();
+			sorted = true;
+			sortedBy = FIELD_TITLE;
 			cout << bids.size() << " bids read" << endl;
 			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
 			displayTime(ticks);
@@ -303,6 +497,9 @@ int main(int argc, char *argv[]) {
 		case 4:
 			ticks = clock();
 			quickSort(bids, 0, bids.size() - 1); // Sort the bids
+			indexes.Invalidate();
+			sorted = true;
+			sortedBy = FIELD_TITLE;
 			cout << bids.size() << " bids read" << endl;
 			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
 			displayTime(ticks);
@@ -316,11 +513,25 @@ int main(int argc, char *argv[]) {
 			bidKey = getBidId();
 
 			// Search for entered bid id
-			for (auto searchBid : bids) {
-				if (searchBid.bidId.compare(bidKey) == 0) {
-					displayBid(searchBid);
+			if (frozen.Size() > 0) {
+				bid = frozen.Search(bidKey);
+				if (!bid.bidId.empty()) {
+					displayBid(bid);
 					bidFound = true;
 				}
+			} else if (sorted && sortedBy == FIELD_BIDID) {
+				matches = interpolationSearchBidId(bids, bidKey);
+				for (unsigned int i = matches.first; i < matches.second; ++i) {
+					displayBid(bids[i]);
+					bidFound = true;
+				}
+			} else {
+				for (const Bid &searchBid : bids) {
+					if (searchBid.bidId.compare(bidKey) == 0) {
+						displayBid(searchBid);
+						bidFound = true;
+					}
+				}
 			}
 			if (!bidFound) {
 				cout << "Bid Id " << bidKey << " not found." << endl;
@@ -335,11 +546,94 @@ int main(int argc, char *argv[]) {
 			ticks = clock();
 			bid = getBid();
 			bids.push_back(bid); // add bid to vector
+			indexes.Invalidate();
+			frozen.Clear();
+			sorted = false;
 			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
 			displayTime(ticks);
 
 			break;
 
+		case 7:
+			queryIndexes(bids, indexes);
+
+			break;
+
+		case 8:
+			ticks = clock();
+			frozen.Build(bids);
+			cout << frozen.Size() << " bids frozen" << endl;
+			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+			displayTime(ticks);
+
+			break;
+
+		case 10:
+			engine = chooseSortEngine(engines);
+			if (engine == nullptr) {
+				break;
+			}
+
+			ticks = clock();
+			engine->sort(bids); // Sort the bids
+			indexes.Invalidate();
+			sorted = true;
+			sortedBy = engine->field;
+			cout << bids.size() << " bids sorted with " << engine->name << endl;
+			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+			displayTime(ticks);
+
+			break;
+
+		case 11:
+			compareSortEngines(bids, engines);
+
+			break;
+
+		case 12:
+			// Prompt user for a specification such as "fund, amount desc"
+			sortSpec = getString("Enter sort columns (bidId, title, fund, amount) with ASC or DESC");
+			if (!parseSortSpec(sortSpec, sortKeys)) {
+				cout << "Not a valid sort specification." << endl;
+				break;
+			}
+
+			ticks = clock();
+			sortBySpec(bids, sortKeys);
+			indexes.Invalidate();
+			sorted = !sortKeys[0].descending;
+			sortedBy = sortKeys[0].field;
+			cout << bids.size() << " bids sorted by " << sortSpec << endl;
+			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+			displayTime(ticks);
+
+			break;
+
+		case 13:
+			// Prompt user for one column, such as "amount desc", and a count
+			sortSpec = getString("Enter a column (bidId, title, fund, amount) with ASC or DESC");
+			if (!parseSortSpec(sortSpec, sortKeys) || sortKeys.size() != 1) {
+				cout << "Not a valid column." << endl;
+				break;
+			}
+			cout << "Enter number of bids: ";
+			if (!(cin >> topCount)) {
+				cin.clear();
+				cin.ignore();
+				break;
+			}
+
+			ticks = clock();
+			topPositions = topK(bids, topCount, sortKeys[0]);
+			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+
+			for (unsigned int position : topPositions) {
+				displayBid(bids[position]);
+			}
+			displayTime(ticks);
+
+			break;
+
 		case 9:
 			break;
 